@@ -0,0 +1,97 @@
+#include "analysis.h"
+
+#include <algorithm>
+#include "perf.h"
+
+static const size_t runLength = 16;  // Consecutive positions taken at a time, they usually come from the same game
+
+PositionAnalyzer::Options PositionAnalyzer::defaultOptions() {
+    Options options;
+    options.probabilities = WhenGuessing;
+    options.budgetMs = 10.0;
+    options.threads = 0;
+    return options;
+}
+
+
+void PositionAnalyzer::analyze(const Position *positions, size_t count, Analysis *results, const Options &options) {
+    PERF_SCOPE("analyze batch");
+    size_t threads = WorkerPool<Worker>::threadCount(options.threads);
+    threads = std::max<size_t>(1, std::min(threads, (count + runLength - 1) / runLength));
+    if (workers.size() < threads) {
+        workers.resize(threads);  // New workers start with no size, so their caches are set up on first use
+    }
+    next.store(0);
+    workers.run(threads, [&](size_t t) { run(workers[t], positions, count, results, options); });
+}
+
+
+void PositionAnalyzer::run(Worker &worker, const Position *positions, size_t count, Analysis *results,
+                           const Options &options) {
+    while (true) {
+        size_t begin = next.fetch_add(runLength);
+        if (begin >= count) {
+            return;
+        }
+        size_t end = std::min(count, begin + runLength);
+        for (size_t i = begin; i < end; ++i) {
+            analyzeOne(worker, positions[i], results[i], options);
+        }
+    }
+}
+
+
+// Rebuilds the position on the worker's board, lets the solver deduce everything it can, then collects the results
+void PositionAnalyzer::analyzeOne(Worker &worker, const Position &position, Analysis &result, const Options &options) {
+    Board &board = worker.board;
+    if (position.rows != worker.rows || position.columns != worker.columns) {
+        worker.probabilities.reset();  // Cached components are keyed by cell index, which depends on the size
+        worker.noFlags.assign(layerWords(position.rows, position.columns), 0);
+        worker.rows = position.rows;
+        worker.columns = position.columns;
+    }
+    board.setupGame(position.rows, position.columns, 0, 0);
+    board.setMineBits(position.mines);
+    board.restoreProgress(position.revealed, worker.noFlags.data(), Board::Playing);
+
+    worker.solver.rebuild(board);
+    int safe = worker.solver.findSafeCell(board);  // Propagates every deduction
+    result.safeCells.clear();
+    result.mineCells.clear();
+    for (int cell = 0; cell < board.cellCount(); ++cell) {
+        if (board.isRevealed(cell)) {
+            continue;
+        }
+        if (worker.solver.isKnownSafe(cell)) {
+            result.safeCells.push_back(cell);
+        } else if (worker.solver.isKnownMine(cell)) {
+            result.mineCells.push_back(cell);
+        }
+    }
+
+    result.guessForced = safe < 0;
+    result.bestGuess = -1;
+    result.bestRisk = 0.0;
+    result.exact = true;
+    result.probabilities.clear();
+    if (options.probabilities == AllPositions || (options.probabilities == WhenGuessing && result.guessForced)) {
+        ProbabilitySolver::Result guess = worker.probabilities.solve(board, worker.solver, options.budgetMs);
+        result.probabilities = worker.probabilities.probabilities();
+        result.exact = guess.exact;
+        if (result.guessForced) {
+            result.bestGuess = guess.bestCell;
+            result.bestRisk = guess.bestProbability;
+        }
+    }
+}
+
+
+size_t PositionAnalyzer::layerWords(int rows, int columns) {
+    return (static_cast<size_t>(rows) * columns + 63) / 64;
+}
+
+
+void PositionAnalyzer::capture(const Board &board, uint64_t *mines, uint64_t *revealed) {
+    board.mineBits().pack(mines);
+    board.revealedBits().pack(revealed);
+}
@@ -0,0 +1,75 @@
+#ifndef ANALYSIS_H
+#define ANALYSIS_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "board.h"
+#include "probability.h"
+#include "solver.h"
+#include "workerpool.h"
+
+// Scores many positions at once for offline analysis, e.g. every move of a batch of recorded games
+// For each position it returns every hidden cell the solver proves safe or a mine, and when no cell is safe,
+// the mine probability of every hidden cell, which tells whether a move was a forced guess and how risky it was
+// Positions are handed out to threads in small runs of consecutive entries; every thread owns its board, solver and
+// probability solver, reused from one position and one call to the next, so the threads never allocate or share state
+class PositionAnalyzer {
+public:
+    // A position as two BitGrid::pack() layers; only the revealed numbers are used, the mines give their counts
+    struct Position {
+        int rows;
+        int columns;
+        const uint64_t *mines;  // Packed mine layer
+        const uint64_t *revealed;  // Packed revealed layer
+    };
+
+    struct Analysis {
+        std::vector<int> safeCells;  // Hidden cells proved safe
+        std::vector<int> mineCells;  // Hidden cells proved to be mines
+        std::vector<float> probabilities;  // Per-cell mine probability, -1 for revealed cells; empty unless computed
+        bool guessForced;  // Whether the solver proves no hidden cell safe; the mine count may still leave a zero risk cell
+        int bestGuess;  // Hidden cell least likely to be a mine when a guess is forced, -1 otherwise
+        double bestRisk;  // Mine probability of bestGuess
+        bool exact;  // False when the probabilities ran out of time and are partly estimates
+    };
+
+    enum ProbabilityMode {
+        NoProbabilities,  // Only the proved cells
+        WhenGuessing,  // Probabilities for positions without a safe cell
+        AllPositions  // Probabilities for every position
+    };
+
+    struct Options {
+        ProbabilityMode probabilities;
+        double budgetMs;  // Time the probability solver may spend on one position
+        int threads;  // Worker threads, 0 picks one per core
+    };
+
+    static Options defaultOptions();  // WhenGuessing, 10 ms per position, one thread per core
+
+    // Fills results[i] for positions[i]; results must hold count entries, their buffers are reused
+    void analyze(const Position *positions, size_t count, Analysis *results, const Options &options);
+
+    static size_t layerWords(int rows, int columns);  // Words of one packed layer
+    static void capture(const Board &board, uint64_t *mines, uint64_t *revealed);  // Packs a board with placed mines
+
+private:
+    // Scratch of one thread
+    struct Worker {
+        Board board;
+        Solver solver;
+        ProbabilitySolver probabilities;
+        std::vector<uint64_t> noFlags;  // Empty flag layer, flags play no part in the analysis
+        int rows, columns;  // Size of the last position, the probability cache is only valid for one size
+    };
+
+    void run(Worker &worker, const Position *positions, size_t count, Analysis *results, const Options &options);
+    void analyzeOne(Worker &worker, const Position &position, Analysis &result, const Options &options);
+
+    WorkerPool<Worker> workers;  // One per analysis thread
+    std::atomic<size_t> next;  // First position not yet handed out
+};
+
+#endif // ANALYSIS_H
@@ -0,0 +1,37 @@
+#ifndef BENCH_COMMON_H
+#define BENCH_COMMON_H
+
+#include <benchmark/benchmark.h>  // Google Benchmark
+#include <vector>
+#include "board.h"
+#include "solver.h"
+
+// Registers the standard board sizes as (rows, columns, mines) arguments
+inline void boardSizes(benchmark::internal::Benchmark *benchmark) {
+    benchmark->ArgNames({"rows", "columns", "mines"});
+    benchmark->Args({9, 9, 10});  // Beginner
+    benchmark->Args({16, 16, 40});  // Intermediate
+    benchmark->Args({16, 30, 99});  // Expert
+    benchmark->Args({1000, 1000, 206250});  // Expert density on a 1000x1000 board
+}
+
+// Plays a seeded game with the solver until the first position that needs a guess, and returns that position
+// Positions are rebuilt the same way on every run, so they act as saved mid-game positions
+inline Board midGamePosition(int rows, int columns, int mines, uint64_t seed) {
+    while (true) {
+        Board board;
+        Solver solver;
+        board.setupGame(rows, columns, mines, seed++);
+        solver.reset(board);
+        int cell = board.index(rows / 2, columns / 2);
+        while (board.state() == Board::Playing && cell >= 0) {
+            solver.update(board, board.revealCell(board.rowOf(cell), board.columnOf(cell)));
+            cell = solver.findSafeCell(board);
+        }
+        if (board.state() == Board::Playing) {
+            return board;
+        }
+    }
+}
+
+#endif // BENCH_COMMON_H
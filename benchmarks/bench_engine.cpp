@@ -0,0 +1,139 @@
+#include <cmath>
+#include "bench_common.h"
+#include "analysis.h"
+#include "generator.h"
+#include "probability.h"
+
+// Board generation: reset plus mine placement and adjacency counts
+static void BM_Generate(benchmark::State &state) {
+    Board board;
+    uint64_t seed = 1;
+    for (auto _ : state) {
+        board.setupGame(state.range(0), state.range(1), state.range(2), seed++);
+        board.placeMines(board.rows() / 2, board.columns() / 2);
+        benchmark::ClobberMemory();
+    }
+}
+BENCHMARK(BM_Generate)->Apply(boardSizes);
+
+// First click of a game, including the cascade it opens
+static void BM_CascadeReveal(benchmark::State &state) {
+    Board board;
+    uint64_t seed = 1;
+    for (auto _ : state) {
+        state.PauseTiming();
+        board.setupGame(state.range(0), state.range(1), state.range(2), seed++);
+        board.placeMines(board.rows() / 2, board.columns() / 2);
+        state.ResumeTiming();
+
+        benchmark::DoNotOptimize(board.revealCell(board.rows() / 2, board.columns() / 2).data());
+    }
+}
+BENCHMARK(BM_CascadeReveal)->Apply(boardSizes);
+
+// Hint from scratch on a mid-game position: full solver rebuild plus propagation
+static void BM_FindSafeCell(benchmark::State &state) {
+    Board board = midGamePosition(state.range(0), state.range(1), state.range(2), 1);
+    Solver solver;
+    for (auto _ : state) {
+        solver.rebuild(board);
+        benchmark::DoNotOptimize(solver.findSafeCell(board));
+    }
+}
+BENCHMARK(BM_FindSafeCell)->Apply(boardSizes);
+
+// Probability hint on a mid-game position where no cell is provably safe, with the GUI time budget and no component cache
+static void BM_ProbabilityHint(benchmark::State &state) {
+    Board board = midGamePosition(state.range(0), state.range(1), state.range(2), 1);
+    Solver solver;
+    solver.rebuild(board);
+    solver.findSafeCell(board);
+    ProbabilitySolver probabilities;
+    for (auto _ : state) {
+        probabilities.reset();
+        benchmark::DoNotOptimize(probabilities.solve(board, solver, 10.0).bestCell);
+    }
+}
+BENCHMARK(BM_ProbabilityHint)->Apply(boardSizes)->Unit(benchmark::kMicrosecond);
+
+// Same with a budget far too small to enumerate the frontier, so unfinished components fall back to estimates
+// A best guess with no risk must really be safe, and the probabilities must still add up to the mine count
+static void BM_ProbabilityHintTightBudget(benchmark::State &state) {
+    Board board = midGamePosition(state.range(0), state.range(1), state.range(2), 1);
+    Solver solver;
+    solver.rebuild(board);
+    solver.findSafeCell(board);
+    ProbabilitySolver probabilities;
+    ProbabilitySolver::Result result = {-1, 1.0, true};
+    for (auto _ : state) {
+        probabilities.reset();
+        result = probabilities.solve(board, solver, 0.05);
+        benchmark::DoNotOptimize(result.bestCell);
+    }
+
+    double expected = 0.0;
+    for (int cell = 0; cell < board.cellCount(); ++cell) {
+        if (!board.isRevealed(cell)) {
+            expected += probabilities.probabilities()[cell];
+        }
+    }
+    if (result.bestCell < 0 || (result.bestProbability == 0.0 && board.isMine(result.bestCell))) {
+        state.SkipWithError("best guess is a mine reported as safe");
+    } else if (std::abs(expected - board.mineCount()) > 0.01 * board.mineCount() + 1.0) {
+        state.SkipWithError("probabilities do not add up to the mine count");
+    }
+}
+BENCHMARK(BM_ProbabilityHintTightBudget)->Apply(boardSizes)->Unit(benchmark::kMicrosecond);
+
+// Engine side of restartGame: board reset and solver state reset
+static void BM_Restart(benchmark::State &state) {
+    Board board;
+    Solver solver;
+    ProbabilitySolver probabilities;
+    uint64_t seed = 1;
+    for (auto _ : state) {
+        board.setupGame(state.range(0), state.range(1), state.range(2), seed++);
+        solver.reset(board);
+        probabilities.reset();
+        benchmark::ClobberMemory();
+    }
+}
+BENCHMARK(BM_Restart)->Apply(boardSizes);
+
+// No-guess generation for a first click in the centre, with the GUI budget; the search is deterministic per seed
+static void BM_NoGuessGenerate(benchmark::State &state) {
+    NoGuessGenerator generator;
+    uint64_t seed = 1;
+    for (auto _ : state) {
+        NoGuessGenerator::Result result = generator.generate(state.range(0), state.range(1), state.range(2), seed++,
+                                                             state.range(0) / 2, state.range(1) / 2, 50.0);
+        benchmark::DoNotOptimize(result.mines.data());
+    }
+}
+BENCHMARK(BM_NoGuessGenerate)->ArgNames({"rows", "columns", "mines"})->Args({9, 9, 10})->Args({16, 16, 40})->Args({16, 30, 99})
+    ->Unit(benchmark::kMillisecond);
+
+// Batch analysis of guess positions from many expert games, probabilities included; the argument is the thread count,
+// 0 for one per core
+static void BM_AnalyzeBatch(benchmark::State &state) {
+    const int positionCount = 256;
+    size_t words = PositionAnalyzer::layerWords(16, 30);
+    std::vector<uint64_t> layers(2 * positionCount * words);
+    std::vector<PositionAnalyzer::Position> positions(positionCount);
+    for (int i = 0; i < positionCount; ++i) {
+        Board board = midGamePosition(16, 30, 99, 1 + 1000 * i);
+        PositionAnalyzer::capture(board, &layers[2 * i * words], &layers[(2 * i + 1) * words]);
+        PositionAnalyzer::Position position = { 16, 30, &layers[2 * i * words], &layers[(2 * i + 1) * words] };
+        positions[i] = position;
+    }
+    std::vector<PositionAnalyzer::Analysis> results(positionCount);
+    PositionAnalyzer::Options options = PositionAnalyzer::defaultOptions();
+    options.threads = static_cast<int>(state.range(0));
+    PositionAnalyzer analyzer;
+    for (auto _ : state) {
+        analyzer.analyze(positions.data(), positions.size(), results.data(), options);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * positionCount);
+}
+BENCHMARK(BM_AnalyzeBatch)->ArgName("threads")->Arg(1)->Arg(0)->Unit(benchmark::kMillisecond)->UseRealTime();
@@ -0,0 +1,16 @@
+#include <QApplication>
+#include <benchmark/benchmark.h>  // Google Benchmark
+
+int main(int argc, char *argv[]) {  // Runs every registered benchmark, pass --benchmark_format=json for machine-readable output
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");  // Render benchmarks need widgets but no display
+    }
+    QApplication app(argc, argv);
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    return 0;
+}
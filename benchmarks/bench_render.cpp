@@ -0,0 +1,21 @@
+#include <QImage>
+#include <QRegion>
+#include "bench_common.h"
+#include "boardview.h"
+#include "iconatlas.h"
+
+// Offscreen repaint of the board widget into an image, limited to a 1920x1080 viewport on boards larger than that
+static void BM_Repaint(benchmark::State &state) {
+    Board board = midGamePosition(state.range(0), state.range(1), state.range(2), 1);
+    IconAtlas icons;
+    icons.load(QSize(25, 24));
+    BoardView view(&board, &icons);
+    QRect viewport = QRect(QPoint(0, 0), view.size()).intersected(QRect(0, 0, 1920, 1080));
+    QImage image(viewport.size(), QImage::Format_ARGB32_Premultiplied);
+
+    for (auto _ : state) {
+        view.render(&image, QPoint(), QRegion(viewport));
+        benchmark::DoNotOptimize(image.constBits());
+    }
+}
+BENCHMARK(BM_Repaint)->Apply(boardSizes)->Unit(benchmark::kMicrosecond);
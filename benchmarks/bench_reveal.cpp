@@ -0,0 +1,44 @@
+#include <benchmark/benchmark.h>  // Google Benchmark
+#include "board.h"
+
+// Measures a single cascade reveal on a 4096x4096 board
+// The argument is the mine density in tenths of a percent, so low densities open most of the board in one click
+static void BM_CascadeReveal4096(benchmark::State &state) {
+    const int size = 4096;
+    const int mines = static_cast<int>(static_cast<long long>(size) * size * state.range(0) / 1000);
+    Board board;
+    uint64_t seed = 1;
+    long long revealed = 0;
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        board.setupGame(size, size, mines, seed++);
+        board.placeMines(size / 2, size / 2);  // The first click is always a zero cell
+        state.ResumeTiming();
+
+        const std::vector<int> &batch = board.revealCell(size / 2, size / 2);
+        benchmark::DoNotOptimize(batch.data());
+        revealed += static_cast<long long>(batch.size());
+    }
+    state.counters["cells/s"] = benchmark::Counter(static_cast<double>(revealed), benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_CascadeReveal4096)->Arg(1)->Arg(5)->Arg(20)->Unit(benchmark::kMillisecond);
+
+// Measures mine placement alone on a 1000x1000 board
+// The argument is the mine density in percent, up to a nearly full board
+static void BM_PlaceMines1000(benchmark::State &state) {
+    const int size = 1000;
+    const int mines = static_cast<int>(static_cast<long long>(size) * size * state.range(0) / 100);
+    Board board;
+    uint64_t seed = 1;
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        board.setupGame(size, size, mines, seed++);
+        state.ResumeTiming();
+
+        board.placeMines(0, 0);
+        benchmark::ClobberMemory();
+    }
+}
+BENCHMARK(BM_PlaceMines1000)->Arg(1)->Arg(20)->Arg(50)->Arg(99)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,43 @@
+TEMPLATE = app
+TARGET = minesweeper-bench
+
+QT += core gui widgets
+
+CONFIG += console c++11 thread
+CONFIG -= app_bundle
+
+INCLUDEPATH += ..
+
+HEADERS += \
+    ../analysis.h \
+    ../bitgrid.h \
+    ../bitset.h \
+    ../board.h \
+    ../boardview.h \
+    ../generator.h \
+    ../iconatlas.h \
+    ../perf.h \
+    ../probability.h \
+    ../rng.h \
+    ../solver.h \
+    ../workerpool.h \
+    bench_common.h
+
+SOURCES += \
+    ../analysis.cpp \
+    ../bitgrid.cpp \
+    ../board.cpp \
+    ../boardview.cpp \
+    ../generator.cpp \
+    ../iconatlas.cpp \
+    ../probability.cpp \
+    ../solver.cpp \
+    bench_engine.cpp \
+    bench_main.cpp \
+    bench_render.cpp \
+    bench_reveal.cpp
+
+RESOURCES += \
+    ../resources.qrc
+
+LIBS += -lbenchmark -lpthread
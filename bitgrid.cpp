@@ -0,0 +1,186 @@
+#include "bitgrid.h"
+
+#include <algorithm>
+
+BitGrid::BitGrid()
+    : rowCount(0), columnCount(0), rowWords(0), stride(2), tailMask(0) {
+}
+
+
+void BitGrid::resize(int rows, int columns) {
+    rowCount = rows;
+    columnCount = columns;
+    rowWords = (columns + 63) / 64;
+    stride = rowWords + 2;
+    tailMask = (columns & 63) ? (uint64_t(1) << (columns & 63)) - 1 : ~uint64_t(0);
+    words.assign(static_cast<size_t>(rows + 2) * stride, 0);
+}
+
+
+void BitGrid::clear() {
+    std::fill(words.begin(), words.end(), 0);
+}
+
+
+int BitGrid::count() const {
+    int total = 0;
+    for (uint64_t word : words) {  // Padding words are always zero
+        total += bitCount(word);
+    }
+    return total;
+}
+
+
+void BitGrid::complement(BitGrid &out) const {
+    if (out.rowCount != rowCount || out.columnCount != columnCount) {
+        out.resize(rowCount, columnCount);
+    }
+    for (int r = 0; r < rowCount; ++r) {
+        const uint64_t *in = rowData(r);
+        uint64_t *result = out.rowData(r);
+        for (int k = 0; k < rowWords; ++k) {
+            result[k] = ~in[k];
+        }
+        result[rowWords - 1] &= tailMask;  // Keep the padding zero
+    }
+}
+
+
+void BitGrid::intersect(const BitGrid &other) {
+    for (size_t i = 0; i < words.size(); ++i) {
+        words[i] &= other.words[i];
+    }
+}
+
+
+void BitGrid::subtract(const BitGrid &other) {
+    for (size_t i = 0; i < words.size(); ++i) {
+        words[i] &= ~other.words[i];
+    }
+}
+
+
+// Adds the eight neighbour masks of every word with full adders working on 64 cells at once
+// The three output planes plus the carry into the eighths place encode counts from 0 to 8
+void BitGrid::neighbourCounts(BitGrid planes[4]) const {
+    for (int i = 0; i < 4; ++i) {
+        if (planes[i].rowCount != rowCount || planes[i].columnCount != columnCount) {
+            planes[i].resize(rowCount, columnCount);
+        }
+    }
+
+    for (int r = 0; r < rowCount; ++r) {
+        const uint64_t *up = rowData(r - 1);
+        const uint64_t *mid = rowData(r);
+        const uint64_t *down = rowData(r + 1);
+        uint64_t *out0 = planes[0].rowData(r);
+        uint64_t *out1 = planes[1].rowData(r);
+        uint64_t *out2 = planes[2].rowData(r);
+        uint64_t *out3 = planes[3].rowData(r);
+
+        for (int k = 0; k < rowWords; ++k) {
+            // Bit c of each mask tells whether the neighbour in that direction of cell c is set
+            uint64_t n = up[k];
+            uint64_t s = down[k];
+            uint64_t w = (mid[k] << 1) | (mid[k - 1] >> 63);
+            uint64_t e = (mid[k] >> 1) | (mid[k + 1] << 63);
+            uint64_t nw = (up[k] << 1) | (up[k - 1] >> 63);
+            uint64_t ne = (up[k] >> 1) | (up[k + 1] << 63);
+            uint64_t sw = (down[k] << 1) | (down[k - 1] >> 63);
+            uint64_t se = (down[k] >> 1) | (down[k + 1] << 63);
+
+            // Full adders reduce the eight one-bit inputs to ones, twos, fours and eights
+            uint64_t s0 = n ^ s ^ w, c0 = (n & s) | (w & (n ^ s));
+            uint64_t s1 = e ^ nw ^ ne, c1 = (e & nw) | (ne & (e ^ nw));
+            uint64_t s2 = sw ^ se, c2 = sw & se;
+            uint64_t ones = s0 ^ s1 ^ s2, c3 = (s0 & s1) | (s2 & (s0 ^ s1));
+            uint64_t t = c0 ^ c1 ^ c2, c4 = (c0 & c1) | (c2 & (c0 ^ c1));
+            uint64_t twos = t ^ c3, c5 = t & c3;
+            uint64_t fours = c4 ^ c5, eights = c4 & c5;
+
+            uint64_t mask = k == rowWords - 1 ? tailMask : ~uint64_t(0);
+            out0[k] = ones & mask;
+            out1[k] = twos & mask;
+            out2[k] = fours & mask;
+            out3[k] = eights & mask;
+        }
+    }
+}
+
+
+void BitGrid::dilate(BitGrid &out) const {
+    if (out.rowCount != rowCount || out.columnCount != columnCount) {
+        out.resize(rowCount, columnCount);
+    }
+
+    for (int r = 0; r < rowCount; ++r) {
+        const uint64_t *up = rowData(r - 1);
+        const uint64_t *mid = rowData(r);
+        const uint64_t *down = rowData(r + 1);
+        uint64_t *result = out.rowData(r);
+
+        for (int k = 0; k < rowWords; ++k) {
+            uint64_t column = up[k] | mid[k] | down[k];  // Vertical neighbours and the cell itself
+            uint64_t left = up[k - 1] | mid[k - 1] | down[k - 1];
+            uint64_t right = up[k + 1] | mid[k + 1] | down[k + 1];
+            uint64_t any = (up[k] | down[k]) | (column << 1) | (left >> 63) | (column >> 1) | (right << 63);
+            result[k] = any & (k == rowWords - 1 ? tailMask : ~uint64_t(0));
+        }
+    }
+}
+
+
+// Compares two sets of neighbourCounts() planes of the same size plane by plane, 64 cells at a time
+void BitGrid::equalCounts(const BitGrid first[4], const BitGrid second[4]) {
+    if (rowCount != first[0].rowCount || columnCount != first[0].columnCount) {
+        resize(first[0].rowCount, first[0].columnCount);
+    }
+
+    for (int r = 0; r < rowCount; ++r) {
+        uint64_t *result = rowData(r);
+        for (int k = 0; k < rowWords; ++k) {
+            uint64_t differ = 0;
+            for (int i = 0; i < 4; ++i) {
+                differ |= first[i].rowData(r)[k] ^ second[i].rowData(r)[k];
+            }
+            result[k] = ~differ & (k == rowWords - 1 ? tailMask : ~uint64_t(0));
+        }
+    }
+}
+
+
+// Cell (r, c) becomes bit r * columns + c of the stream, so rows are no longer word aligned: each word of a row
+// is split across at most two words of the stream
+void BitGrid::pack(uint64_t *out) const {
+    size_t total = packedWords();
+    std::fill(out, out + total, 0);
+    for (int r = 0; r < rowCount; ++r) {
+        const uint64_t *row = rowData(r);
+        for (int k = 0; k < rowWords; ++k) {
+            size_t position = static_cast<size_t>(r) * columnCount + (static_cast<size_t>(k) << 6);
+            size_t shift = position & 63;
+            uint64_t word = row[k];
+            out[position >> 6] |= word << shift;
+            if (shift && (word >> (64 - shift))) {  // Only non-zero when the row continues past the stream word
+                out[(position >> 6) + 1] |= word >> (64 - shift);
+            }
+        }
+    }
+}
+
+
+void BitGrid::unpack(const uint64_t *in) {
+    size_t total = packedWords();
+    for (int r = 0; r < rowCount; ++r) {
+        uint64_t *row = rowData(r);
+        for (int k = 0; k < rowWords; ++k) {
+            size_t position = static_cast<size_t>(r) * columnCount + (static_cast<size_t>(k) << 6);
+            size_t shift = position & 63;
+            uint64_t word = in[position >> 6] >> shift;
+            if (shift && (position >> 6) + 1 < total) {
+                word |= in[(position >> 6) + 1] << (64 - shift);
+            }
+            row[k] = k == rowWords - 1 ? word & tailMask : word;  // Drop the bits of the next row
+        }
+    }
+}
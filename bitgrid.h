@@ -0,0 +1,74 @@
+#ifndef BITGRID_H
+#define BITGRID_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+inline int lowestBit(uint64_t word) { unsigned long index; _BitScanForward64(&index, word); return static_cast<int>(index); }
+inline int bitCount(uint64_t word) { return static_cast<int>(__popcnt64(word)); }
+#else
+inline int lowestBit(uint64_t word) { return __builtin_ctzll(word); }
+inline int bitCount(uint64_t word) { return __builtin_popcountll(word); }
+#endif
+
+// Packed bitboard of a rows x columns grid, 64 cells per word, one run of words per row
+// Every row is framed by a zero word on each side and the grid by a zero row above and below,
+// so neighbour kernels can shift across word and row boundaries without bounds checks
+class BitGrid {
+public:
+    BitGrid();
+
+    void resize(int rows, int columns);  // Resizes the grid and clears every bit
+    void clear();  // Clears every bit, keeping the size
+
+    int rows() const { return rowCount; }
+    int columns() const { return columnCount; }
+    int wordsPerRow() const { return rowWords; }
+
+    bool test(int row, int col) const { return (rowData(row)[col >> 6] >> (col & 63)) & 1; }
+    void set(int row, int col) { rowData(row)[col >> 6] |= uint64_t(1) << (col & 63); }
+    void reset(int row, int col) { rowData(row)[col >> 6] &= ~(uint64_t(1) << (col & 63)); }
+
+    const uint64_t *rowData(int row) const { return &words[(row + 1) * stride + 1]; }  // Row -1 and row rows() read as zero
+    uint64_t *rowData(int row) { return &words[(row + 1) * stride + 1]; }
+    uint64_t lastWordMask() const { return tailMask; }  // Bits of the last word of a row that lie inside the grid
+
+    int count() const;  // Number of set bits
+    void complement(BitGrid &out) const;  // Writes every cell that is not set
+    void intersect(const BitGrid &other);  // Keeps only the bits also set in other, which must have the same size
+    void subtract(const BitGrid &other);  // Clears the bits set in other, which must have the same size
+    void neighbourCounts(BitGrid planes[4]) const;  // Bit-sliced count of set neighbours, plane i holds bit i of the count
+    void dilate(BitGrid &out) const;  // Writes every cell with at least one set neighbour
+    void equalCounts(const BitGrid first[4], const BitGrid second[4]);  // Sets the cells where two counts are equal
+    void pack(uint64_t *out) const;  // Writes the cells as a dense row-major bit stream of packedWords() words
+    void unpack(const uint64_t *in);  // Reads cells written by pack() for a grid of the same size
+    size_t packedWords() const { return (static_cast<size_t>(rowCount) * columnCount + 63) / 64; }
+
+    // Calls visit(row, col) for every set bit, in row-major order
+    template <typename Visitor>
+    void forEach(Visitor visit) const {
+        for (int r = 0; r < rowCount; ++r) {
+            const uint64_t *row = rowData(r);
+            for (int k = 0; k < rowWords; ++k) {
+                uint64_t word = row[k];
+                while (word) {
+                    visit(r, (k << 6) + lowestBit(word));
+                    word &= word - 1;  // Clear the lowest set bit
+                }
+            }
+        }
+    }
+
+private:
+    std::vector<uint64_t> words;  // Padded storage, see the class comment
+    int rowCount;  // Number of rows in the grid
+    int columnCount;  // Number of columns in the grid
+    int rowWords;  // Words holding the cells of one row
+    int stride;  // Words per padded row
+    uint64_t tailMask;  // Valid bits of the last word of each row
+};
+
+#endif // BITGRID_H
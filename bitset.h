@@ -0,0 +1,20 @@
+#ifndef BITSET_H
+#define BITSET_H
+
+#include <cstdint>
+#include <vector>
+
+// Resizable set of bits packed into 64-bit words, one bit per cell
+class Bitset {
+public:
+    void resize(int bits) { words.assign((bits + 63) / 64, 0); }  // Resizes the set and clears every bit
+
+    bool test(int i) const { return (words[i >> 6] >> (i & 63)) & 1; }
+    void set(int i) { words[i >> 6] |= uint64_t(1) << (i & 63); }
+    void reset(int i) { words[i >> 6] &= ~(uint64_t(1) << (i & 63)); }
+
+private:
+    std::vector<uint64_t> words;  // Bit i lives in word i / 64
+};
+
+#endif // BITSET_H
@@ -0,0 +1,369 @@
+#include "board.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include "perf.h"
+#include "rng.h"
+
+Board::Board()
+    : rowCount(0), columnCount(0), numMines(0), numRevealed(0), gameSeed(0), placed(false), gameState(Playing) {
+}
+
+
+// Resets the board for a new game, reusing the buffers of the previous one
+// Mines are only placed on the first reveal so that the first click and its neighbours are always safe
+void Board::setupGame(int rows, int columns, int mines, uint64_t seed) {
+    rowCount = rows;
+    columnCount = columns;
+    numMines = std::max(0, std::min(mines, cellCount() - 1));  // Always leave at least the first click free
+    numRevealed = 0;
+    gameSeed = seed;
+    placed = false;
+    gameState = Playing;
+    cells.assign(cellCount(), 0);  // Reset every cell to hidden, unflagged and empty
+    mineGrid.resize(rows, columns);
+    revealedGrid.resize(rows, columns);
+    flaggedGrid.resize(rows, columns);
+    revealBatch.clear();
+    revealBatch.reserve(cellCount());  // A single reveal can never touch more cells than the board has
+    flagBatch.clear();
+}
+
+
+// Places the mines with a partial Fisher-Yates shuffle of the cell index array, which finishes in O(mines) at any density
+// Cells around (safeRow, safeCol) are excluded when there is room, otherwise only the cell itself
+// Adjacency counts are then computed for the whole grid at once by the bit-sliced neighbour count kernel
+void Board::placeMines(int safeRow, int safeCol) {
+    PERF_SCOPE("place mines");
+    // Any prefix of the identity permutation is one, so the array only ever grows, when a larger board first needs it
+    size_t known = candidates.size();
+    if (known < static_cast<size_t>(cellCount())) {
+        candidates.resize(cellCount());
+        for (size_t i = known; i < candidates.size(); ++i) {
+            candidates[i] = static_cast<int>(i);
+        }
+    }
+
+    Rng rng(gameSeed);
+    int radius = cellCount() - numMines >= 9 ? 1 : 0;  // Size of the excluded neighbourhood
+
+    // The array always starts as the identity permutation, so the layout only depends on the seed and the first click
+    int end = cellCount();
+    swaps.clear();
+    for (int i = 0; i < numMines; ++i) {
+        int cell;
+        while (true) {
+            int pick = i + static_cast<int>(rng.bounded(static_cast<uint32_t>(end - i)));
+            cell = candidates[pick];
+            if (std::abs(rowOf(cell) - safeRow) > radius || std::abs(columnOf(cell) - safeCol) > radius) {
+                std::swap(candidates[i], candidates[pick]);
+                swaps.push_back(i);
+                swaps.push_back(pick);
+                break;
+            }
+            --end;
+            std::swap(candidates[pick], candidates[end]);  // Move excluded cells out of the range, at most nine times
+            swaps.push_back(pick);
+            swaps.push_back(end);
+        }
+
+        cells[cell] |= MineBit;
+        mineGrid.set(rowOf(cell), columnOf(cell));
+    }
+
+    // Undo the swaps in reverse order, restoring the identity permutation in O(mines)
+    for (size_t i = swaps.size(); i > 0; i -= 2) {
+        std::swap(candidates[swaps[i - 2]], candidates[swaps[i - 1]]);
+    }
+
+    mineGrid.neighbourCounts(countPlanes);
+    storeCounts(countPlanes);
+    placed = true;
+}
+
+
+// Places a layout chosen elsewhere, the number of mines follows the layout
+void Board::setMines(const std::vector<int> &mineCells) {
+    for (int cell : mineCells) {
+        cells[cell] |= MineBit;
+        mineGrid.set(rowOf(cell), columnOf(cell));
+    }
+    numMines = static_cast<int>(mineCells.size());
+
+    mineGrid.neighbourCounts(countPlanes);
+    storeCounts(countPlanes);
+    placed = true;
+}
+
+
+// Spreads the 8 bits of a byte to the lowest bit of 8 consecutive bytes, lowest bit first
+static inline uint64_t spreadByte(uint64_t byte) {
+    uint64_t isolated = (byte * 0x0101010101010101ULL) & 0x8040201008040201ULL;  // Byte i keeps only bit i
+    return ((isolated + 0x7F7F7F7F7F7F7F7FULL) >> 7) & 0x0101010101010101ULL;  // Any set bit carries into the top of its byte
+}
+
+
+// Places a layout stored as a packed bit layer, e.g. straight from a memory-mapped puzzle archive
+void Board::setMineBits(const uint64_t *packed) {
+    mineGrid.unpack(packed);
+    mineGrid.forEach([this](int row, int col) { cells[index(row, col)] |= MineBit; });
+    numMines = mineGrid.count();
+
+    mineGrid.neighbourCounts(countPlanes);
+    storeCounts(countPlanes);
+    placed = true;
+}
+
+
+// Revealed cells are taken as they are, without flood fill, since a saved game already holds whole cascades
+void Board::restoreProgress(const uint64_t *revealed, const uint64_t *flagged, State state) {
+    revealedGrid.unpack(revealed);
+    flaggedGrid.unpack(flagged);
+    revealedGrid.forEach([this](int row, int col) { cells[index(row, col)] |= RevealedBit; });
+    flaggedGrid.forEach([this](int row, int col) { cells[index(row, col)] |= FlaggedBit; });
+    numRevealed = revealedGrid.count();
+    gameState = state;
+}
+
+
+// Used by the no-guess generator to repair a layout while it is being played, only the cells around both ends change
+void Board::moveMine(int from, int to) {
+    int neighbourCells[8];
+    cells[from] &= ~MineBit;
+    mineGrid.reset(rowOf(from), columnOf(from));
+    int count = neighbours(from, neighbourCells);
+    for (int i = 0; i < count; ++i) {
+        cells[neighbourCells[i]]--;  // The count sits in the low bits, which are never zero next to a mine
+    }
+
+    cells[to] |= MineBit;
+    mineGrid.set(rowOf(to), columnOf(to));
+    count = neighbours(to, neighbourCells);
+    for (int i = 0; i < count; ++i) {
+        cells[neighbourCells[i]]++;
+    }
+}
+
+
+// Assembles each cell's count from the four planes, eight cells per step without branches on the cell contents
+void Board::storeCounts(const BitGrid planes[4]) {
+    for (int r = 0; r < rowCount; ++r) {
+        const uint64_t *ones = planes[0].rowData(r);
+        const uint64_t *twos = planes[1].rowData(r);
+        const uint64_t *fours = planes[2].rowData(r);
+        const uint64_t *eights = planes[3].rowData(r);
+        unsigned char *row = &cells[r * columnCount];
+
+        int c = 0;
+        for (; c + 8 <= columnCount; c += 8) {
+            int word = c >> 6;
+            int shift = c & 63;
+            uint64_t counts = spreadByte((ones[word] >> shift) & 0xFF) |
+                              spreadByte((twos[word] >> shift) & 0xFF) << 1 |
+                              spreadByte((fours[word] >> shift) & 0xFF) << 2 |
+                              spreadByte((eights[word] >> shift) & 0xFF) << 3;
+            uint64_t bytes;
+            std::memcpy(&bytes, row + c, 8);
+            bytes = (bytes & 0xF0F0F0F0F0F0F0F0ULL) | counts;  // Keep the state bits of each cell
+            std::memcpy(row + c, &bytes, 8);
+        }
+        for (; c < columnCount; ++c) {  // Remaining cells of the row
+            int word = c >> 6;
+            int bit = c & 63;
+            unsigned char count = static_cast<unsigned char>(((ones[word] >> bit) & 1) | (((twos[word] >> bit) & 1) << 1) |
+                                                             (((fours[word] >> bit) & 1) << 2) | (((eights[word] >> bit) & 1) << 3));
+            row[c] = (row[c] & ~CountMask) | count;
+        }
+    }
+}
+
+
+// Reveals the content of a cell at the specified row and column
+// Ends the game if a mine is revealed, otherwise reveals the cell and potentially its safe neighbours
+// The returned batch stays valid until the next reveal
+const std::vector<int> &Board::revealCell(int row, int col) {
+    PERF_SCOPE("reveal");
+    revealBatch.clear();
+    flagBatch.clear();
+    if (gameState != Playing || isRevealed(row, col)) {
+        return revealBatch;
+    }
+    if (!placed) {
+        placeMines(row, col);
+    }
+    if (isMine(row, col)) {
+        gameState = Lost;
+        return revealBatch;
+    }
+
+    if (isFlagged(row, col)) {
+        flagBatch.push_back(index(row, col));
+    }
+    cells[index(row, col)] = (cells[index(row, col)] & ~FlaggedBit) | RevealedBit;
+    revealedGrid.set(row, col);
+    flaggedGrid.reset(row, col);
+    revealBatch.push_back(index(row, col));
+    revealAdjacentCells();
+    finishReveal();
+    return revealBatch;
+}
+
+
+// Chording: once a revealed number has as many flags around it as it counts, all its other hidden neighbours are
+// revealed together, and a single flood fill continues from every zero among them
+// A wrong flag makes one of those neighbours a mine, which loses the game like any other reveal of a mine
+const std::vector<int> &Board::chordCell(int row, int col) {
+    PERF_SCOPE("chord");
+    revealBatch.clear();
+    flagBatch.clear();
+    if (gameState != Playing || !isRevealed(row, col)) {
+        return revealBatch;
+    }
+
+    int neighbourCells[8];
+    int count = neighbours(index(row, col), neighbourCells);
+    int flags = 0;
+    for (int i = 0; i < count; ++i) {
+        flags += isFlagged(neighbourCells[i]);
+    }
+    if (flags != adjacentMines(row, col)) {
+        return revealBatch;  // Not satisfied, chording would be a guess
+    }
+
+    for (int i = 0; i < count; ++i) {
+        int cell = neighbourCells[i];
+        if (!(cells[cell] & (RevealedBit | FlaggedBit)) && (cells[cell] & MineBit)) {
+            gameState = Lost;
+            return revealBatch;
+        }
+    }
+    for (int i = 0; i < count; ++i) {
+        int cell = neighbourCells[i];
+        if (!(cells[cell] & (RevealedBit | FlaggedBit))) {
+            cells[cell] |= RevealedBit;
+            revealedGrid.set(rowOf(cell), columnOf(cell));
+            revealBatch.push_back(cell);
+        }
+    }
+    revealAdjacentCells();
+    finishReveal();
+    return revealBatch;
+}
+
+
+void Board::finishReveal() {
+    PERF_COUNT("cells revealed", revealBatch.size());
+    numRevealed += static_cast<int>(revealBatch.size());
+    if (numRevealed == cellCount() - numMines) {  // Check if all non-mine cells have been revealed
+        gameState = Won;
+    }
+}
+
+
+// Breadth-first flood fill that walks the reveal batch as its queue, so no recursion and no allocation is needed
+// Every cell is marked revealed as it is queued, which guarantees it is queued at most once
+void Board::revealAdjacentCells() {
+    for (size_t head = 0; head < revealBatch.size(); ++head) {
+        int cell = revealBatch[head];
+        if (cells[cell] & CountMask) {  // Only cells with no adjacent mines spread the reveal
+            continue;
+        }
+
+        int row = cell / columnCount;
+        int col = cell % columnCount;
+        int rowFirst = row > 0 ? row - 1 : row;
+        int rowLast = row < rowCount - 1 ? row + 1 : row;
+        int colFirst = col > 0 ? col - 1 : col;
+        int colLast = col < columnCount - 1 ? col + 1 : col;
+        for (int r = rowFirst; r <= rowLast; ++r) {
+            for (int c = colFirst; c <= colLast; ++c) {
+                int neighbour = r * columnCount + c;
+                if (!(cells[neighbour] & RevealedBit)) {  // Neighbours of a zero cell are never mines
+                    if (cells[neighbour] & FlaggedBit) {
+                        flagBatch.push_back(neighbour);  // A wrong flag, kept so the reveal can be undone exactly
+                    }
+                    cells[neighbour] = (cells[neighbour] & ~FlaggedBit) | RevealedBit;
+                    revealedGrid.set(r, c);
+                    flaggedGrid.reset(r, c);
+                    revealBatch.push_back(neighbour);
+                }
+            }
+        }
+    }
+}
+
+
+// Toggles a flag on a hidden cell, used to mark suspected mines
+bool Board::markCell(int row, int col) {
+    if (gameState != Playing || isRevealed(row, col)) {
+        return false;
+    }
+    cells[index(row, col)] ^= FlaggedBit;
+    if (isFlagged(row, col)) {
+        flaggedGrid.set(row, col);
+    } else {
+        flaggedGrid.reset(row, col);
+    }
+    return true;
+}
+
+
+void Board::setFlag(int row, int col, bool flagged) {
+    if (isRevealed(row, col)) {
+        return;
+    }
+    if (flagged) {
+        cells[index(row, col)] |= FlaggedBit;
+        flaggedGrid.set(row, col);
+    } else {
+        cells[index(row, col)] &= ~FlaggedBit;
+        flaggedGrid.reset(row, col);
+    }
+}
+
+
+// Only the given cells are touched, so undoing a move costs as much as the move itself
+void Board::hideCells(const int *cellList, int count) {
+    for (int i = 0; i < count; ++i) {
+        int cell = cellList[i];
+        cells[cell] &= ~RevealedBit;
+        revealedGrid.reset(rowOf(cell), columnOf(cell));
+    }
+    numRevealed -= count;
+    gameState = Playing;
+}
+
+
+// Used for the hint snapshot: the count planes, batches and mine placement buffers are left out, on a large board
+// they cost more to copy than the game itself
+void Board::snapshot(const Board &source) {
+    cells = source.cells;
+    mineGrid = source.mineGrid;
+    revealedGrid = source.revealedGrid;
+    flaggedGrid = source.flaggedGrid;
+    revealBatch.clear();
+    flagBatch.clear();
+    rowCount = source.rowCount;
+    columnCount = source.columnCount;
+    numMines = source.numMines;
+    numRevealed = source.numRevealed;
+    gameSeed = source.gameSeed;
+    placed = source.placed;
+    gameState = source.gameState;
+}
+
+
+int Board::neighbours(int cell, int *out) const {
+    int row = rowOf(cell);
+    int col = columnOf(cell);
+    int count = 0;
+    for (int r = std::max(0, row - 1); r <= std::min(rowCount - 1, row + 1); ++r) {
+        for (int c = std::max(0, col - 1); c <= std::min(columnCount - 1, col + 1); ++c) {
+            if (r != row || c != col) {
+                out[count++] = r * columnCount + c;
+            }
+        }
+    }
+    return count;
+}
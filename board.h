@@ -0,0 +1,95 @@
+#ifndef BOARD_H
+#define BOARD_H
+
+#include <cstdint>
+#include <vector>
+#include "bitgrid.h"
+
+// Headless minesweeper engine with no GUI dependency
+// Every cell lives in one byte of a flat row-major array: the low bits hold the adjacent mine count,
+// the high bits hold the mine, revealed and flagged state
+// The mine, revealed and flagged state is mirrored in bitboards for word-parallel analysis kernels
+class Board {
+public:
+    enum CellBits : unsigned char {
+        CountMask = 0x0F,  // Number of adjacent mines (0-8)
+        MineBit = 0x10,  // Cell contains a mine
+        RevealedBit = 0x20,  // Cell has been revealed by the player
+        FlaggedBit = 0x40  // Cell has been flagged by the player
+    };
+
+    enum State {
+        Playing,  // Game in progress
+        Won,  // Every safe cell has been revealed
+        Lost  // A mine has been revealed
+    };
+
+    Board();
+
+    void setupGame(int rows, int columns, int numMines, uint64_t seed);  // Resets the board, mines are placed on the first reveal
+    void placeMines(int safeRow, int safeCol);  // Places the mines away from the given cell and computes adjacency counts
+    void setMines(const std::vector<int> &mineCells);  // Places the mines on the given cells instead, e.g. a generated layout
+    void moveMine(int from, int to);  // Moves a placed mine to another cell and updates the counts around both
+    void setMineBits(const uint64_t *packed);  // Places the mines from a layer written by BitGrid::pack()
+    void restoreProgress(const uint64_t *revealed, const uint64_t *flagged, State state);  // Restores packed layers of a saved game
+    const std::vector<int> &revealCell(int row, int col);  // Reveals a cell, returns every cell index it revealed
+    const std::vector<int> &chordCell(int row, int col);  // Reveals the unflagged neighbours of a satisfied number as one batch
+    bool markCell(int row, int col);  // Toggles the flag on a hidden cell, returns whether it changed
+    void setFlag(int row, int col, bool flagged);  // Sets the flag state of a hidden cell
+    void hideCells(const int *cellList, int count);  // Takes back revealed cells for undo, the game is in play again
+    void snapshot(const Board &source);  // Copies the game of source without its scratch buffers, reusing this board's storage
+
+    int rows() const { return rowCount; }
+    int columns() const { return columnCount; }
+    int mineCount() const { return numMines; }
+    uint64_t seed() const { return gameSeed; }
+    bool minesPlaced() const { return placed; }
+    int cellCount() const { return rowCount * columnCount; }
+    int revealedCount() const { return numRevealed; }
+    State state() const { return gameState; }
+    const std::vector<int> &clearedFlags() const { return flagBatch; }  // Flagged cells the last reveal uncovered
+
+    int index(int row, int col) const { return row * columnCount + col; }
+    int rowOf(int index) const { return index / columnCount; }
+    int columnOf(int index) const { return index % columnCount; }
+    bool contains(int row, int col) const { return row >= 0 && row < rowCount && col >= 0 && col < columnCount; }
+
+    bool isMine(int row, int col) const { return cells[index(row, col)] & MineBit; }
+    bool isRevealed(int row, int col) const { return cells[index(row, col)] & RevealedBit; }
+    bool isFlagged(int row, int col) const { return cells[index(row, col)] & FlaggedBit; }
+    int adjacentMines(int row, int col) const { return cells[index(row, col)] & CountMask; }
+
+    bool isMine(int cell) const { return cells[cell] & MineBit; }
+    bool isRevealed(int cell) const { return cells[cell] & RevealedBit; }
+    bool isFlagged(int cell) const { return cells[cell] & FlaggedBit; }
+    int adjacentMines(int cell) const { return cells[cell] & CountMask; }
+    int neighbours(int cell, int *out) const;  // Writes the indices of the up to 8 cells around a cell, returns how many
+
+    const BitGrid &mineBits() const { return mineGrid; }
+    const BitGrid &revealedBits() const { return revealedGrid; }
+    const BitGrid &flaggedBits() const { return flaggedGrid; }
+
+private:
+    void revealAdjacentCells();  // Flood-fills outwards from the zero cells in the reveal batch
+    void finishReveal();  // Counts the batch and checks for the win once per action
+    void storeCounts(const BitGrid planes[4]);  // Copies bit-sliced adjacency counts into the cell bytes
+
+    std::vector<unsigned char> cells;  // Packed cell state, one byte per cell in row-major order
+    BitGrid mineGrid;  // Bitboard of the mines
+    BitGrid revealedGrid;  // Bitboard of the revealed cells
+    BitGrid flaggedGrid;  // Bitboard of the flagged cells
+    BitGrid countPlanes[4];  // Scratch planes for the neighbour count kernel
+    std::vector<int> revealBatch;  // Cells revealed by the last action, doubles as the flood fill queue
+    std::vector<int> flagBatch;  // Cells of revealBatch whose flag the reveal removed
+    std::vector<int> candidates;  // Identity permutation of at least the cell indices, partially shuffled to pick mine positions
+    std::vector<int> swaps;  // Positions swapped while placing mines, used to restore candidates
+    int rowCount;  // Number of rows in the grid
+    int columnCount;  // Number of columns in the grid
+    int numMines;  // Number of mines on the grid
+    int numRevealed;  // Number of safe cells revealed so far
+    uint64_t gameSeed;  // Seed the mine layout is derived from
+    bool placed;  // Whether the mines have been placed yet
+    State gameState;  // Current outcome of the game
+};
+
+#endif // BOARD_H
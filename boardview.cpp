@@ -0,0 +1,135 @@
+#include "boardview.h"
+
+#include <QPainter>
+#include <algorithm>
+#include "perf.h"
+
+BoardView::BoardView(const Board *board, const IconAtlas *icons, QWidget *parent)
+    : QWidget(parent), board(board), icons(icons), hintRow(-1), hintCol(-1), heatMap(nullptr) {
+    setAttribute(Qt::WA_OpaquePaintEvent);  // Every pixel is covered by a tile, so Qt can skip clearing the background
+    boardResized();
+}
+
+
+QSize BoardView::sizeHint() const {
+    QSize cell = icons->tileSize();
+    return QSize(board->columns() * cell.width(), board->rows() * cell.height());
+}
+
+
+void BoardView::boardResized() {
+    setFixedSize(sizeHint());
+    update();
+}
+
+
+QRect BoardView::cellRect(int row, int col) const {
+    QSize cell = icons->tileSize();
+    return QRect(col * cell.width(), row * cell.height(), cell.width(), cell.height());
+}
+
+
+void BoardView::updateCell(int row, int col) {
+    update(cellRect(row, col));
+}
+
+
+// Repaints the bounding rectangle of the batch with a single update request
+void BoardView::updateCells(const std::vector<int> &cells) {
+    if (cells.empty()) {
+        return;
+    }
+
+    int top = board->rows(), bottom = -1, left = board->columns(), right = -1;
+    for (int cell : cells) {
+        int row = board->rowOf(cell);
+        int col = board->columnOf(cell);
+        top = std::min(top, row);
+        bottom = std::max(bottom, row);
+        left = std::min(left, col);
+        right = std::max(right, col);
+    }
+    update(cellRect(top, left).united(cellRect(bottom, right)));
+}
+
+
+void BoardView::setHintCell(int row, int col) {
+    if (hintRow > -1) {
+        updateCell(hintRow, hintCol);  // Clear the previous hint
+    }
+    hintRow = row;
+    hintCol = col;
+    if (hintRow > -1) {
+        updateCell(hintRow, hintCol);
+    }
+}
+
+
+void BoardView::setHeatMap(const std::vector<float> *probabilities) {
+    if (heatMap != probabilities || probabilities) {  // The same map may hold new values
+        heatMap = probabilities;
+        update();
+    }
+}
+
+
+// Revealed cells show their count; hidden cells show a mine once the game is over, otherwise a flag, the hint or nothing
+int BoardView::tileAt(int row, int col) const {
+    if (board->isRevealed(row, col)) {
+        return board->adjacentMines(row, col);
+    }
+    if (board->state() != Board::Playing && board->isMine(row, col)) {
+        return IconAtlas::Mine;
+    }
+    if (board->isFlagged(row, col)) {
+        return IconAtlas::Flag;
+    }
+    if (row == hintRow && col == hintCol) {
+        return IconAtlas::Hint;
+    }
+    return IconAtlas::Empty;
+}
+
+
+void BoardView::paintEvent(QPaintEvent *event) {
+    PERF_FRAME();
+    QPainter painter(this);
+    QSize cell = icons->tileSize();
+    QRect dirty = event->rect();
+
+    // Only walk the cells that intersect the dirty rectangle
+    int firstRow = std::max(0, dirty.top() / cell.height());
+    int lastRow = std::min(board->rows() - 1, dirty.bottom() / cell.height());
+    int firstCol = std::max(0, dirty.left() / cell.width());
+    int lastCol = std::min(board->columns() - 1, dirty.right() / cell.width());
+    PERF_COUNT("icons drawn", std::max(0, lastRow - firstRow + 1) * std::max(0, lastCol - firstCol + 1));
+
+    for (int i = firstRow; i <= lastRow; ++i) {
+        for (int j = firstCol; j <= lastCol; ++j) {
+            painter.drawPixmap(j * cell.width(), i * cell.height(), icons->pixmap(tileAt(i, j)));
+            if (heatMap && !board->isRevealed(i, j)) {
+                // Tint hidden cells red in proportion to their mine probability
+                float probability = (*heatMap)[board->index(i, j)];
+                painter.fillRect(cellRect(i, j), QColor(255, 0, 0, static_cast<int>(probability * 160.0f)));
+            }
+        }
+    }
+}
+
+
+// Maps the click position to a cell in constant time using the cell size
+void BoardView::mousePressEvent(QMouseEvent *event) {
+    QSize cell = icons->tileSize();
+    int row = event->pos().y() / cell.height();
+    int col = event->pos().x() / cell.width();
+    if (event->pos().x() < 0 || event->pos().y() < 0 || !board->contains(row, col)) {
+        return;
+    }
+
+    if (event->button() == Qt::LeftButton) {
+        emit cellClicked(row, col);
+    }
+    else if (event->button() == Qt::RightButton) {
+        emit cellMarked(row, col);
+    }
+}
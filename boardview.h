@@ -0,0 +1,44 @@
+#ifndef BOARDVIEW_H
+#define BOARDVIEW_H
+
+#include <QWidget>
+#include <QMouseEvent>
+#include <QPaintEvent>
+#include <vector>
+#include "board.h"
+#include "iconatlas.h"
+
+// Draws the whole minefield in a single widget and maps mouse positions straight to cells
+// Replaces one QPushButton per cell, so large boards cost one widget instead of rows * columns
+class BoardView : public QWidget {
+    Q_OBJECT
+
+public:
+    BoardView(const Board *board, const IconAtlas *icons, QWidget *parent = nullptr);
+
+    QSize sizeHint() const override;  // Size needed to show every cell
+    void boardResized();  // Adapts the widget to new board dimensions or cell size
+    void updateCell(int row, int col);  // Schedules a repaint of a single cell
+    void updateCells(const std::vector<int> &cells);  // Schedules a repaint of the area covering a batch of cells
+    void setHintCell(int row, int col);  // Marks the hinted cell, (-1, -1) clears it
+    void setHeatMap(const std::vector<float> *probabilities);  // Overlays per-cell mine probabilities, nullptr hides them
+
+signals:
+    void cellClicked(int row, int col);  // Emitted when a cell is left-clicked
+    void cellMarked(int row, int col);  // Emitted when a cell is right-clicked
+
+protected:
+    void paintEvent(QPaintEvent *event) override;  // Paints only the cells inside the dirty region
+    void mousePressEvent(QMouseEvent *event) override;  // Converts the click position to a cell
+
+private:
+    int tileAt(int row, int col) const;  // Picks the atlas tile describing a cell
+    QRect cellRect(int row, int col) const;  // Area covered by a cell in widget coordinates
+
+    const Board *board;  // Engine being displayed, owned by the main window
+    const IconAtlas *icons;  // Shared cell images, owned by the main window
+    int hintRow, hintCol;  // Cell currently shown as a hint
+    const std::vector<float> *heatMap;  // Mine probability of each cell, owned by the main window
+};
+
+#endif // BOARDVIEW_H
@@ -0,0 +1,325 @@
+#include "endless.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include "perf.h"
+#include "rng.h"
+
+static const int floodLimit = 1 << 16;  // Cells one call may reveal, the rest of a huge cascade continues on the next call
+
+EndlessBoard::EndlessBoard()
+    : floodHead(0), gameSeed(0), threshold(0), clock(0), numRevealed(0), lastSlot(-1), safeX(0), safeY(0),
+      started(false), gameState(Board::Playing) {
+    halo.resize(ChunkSize + 2, ChunkSize + 2);
+}
+
+
+void EndlessBoard::setupGame(uint64_t seed, double density, int residentChunks) {
+    gameSeed = seed;
+    // Below about 10% the zero cells percolate and a cascade would never end, 12% keeps them in finite islands
+    density = std::max(0.12, std::min(density, 0.9));
+    threshold = static_cast<uint64_t>(density * 18446744073709551616.0);  // density * 2^64
+    clock = 0;
+    numRevealed = 0;
+    lastSlot = -1;
+    started = false;
+    gameState = Board::Playing;
+
+    size_t limit = std::max(16, residentChunks);  // A flood fill needs the chunks around its current cell
+    pool.clear();
+    pool.reserve(limit);  // Never reallocates afterwards, so chunk references stay valid between evictions
+    resident.clear();
+    store.clear();
+    floodQueue.clear();
+    floodHead = 0;
+}
+
+
+// splitmix64 finaliser over the seed and both coordinates
+bool EndlessBoard::isMine(int x, int y) const {
+    if (started && std::abs(static_cast<int64_t>(x) - safeX) <= 1 && std::abs(static_cast<int64_t>(y) - safeY) <= 1) {
+        return false;
+    }
+    return mixSeed(gameSeed ^ (static_cast<uint64_t>(static_cast<uint32_t>(x)) * 0x9E3779B97F4A7C15ULL) ^
+                   (static_cast<uint64_t>(static_cast<uint32_t>(y)) * 0xC2B2AE3D27D4EB4FULL)) < threshold;
+}
+
+
+unsigned char EndlessBoard::cellAt(int x, int y) {
+    Chunk &chunk = chunkAt(chunkOf(x), chunkOf(y));
+    return chunk.cells[(y & (ChunkSize - 1)) * ChunkSize + (x & (ChunkSize - 1))];
+}
+
+
+EndlessBoard::Chunk &EndlessBoard::chunkAt(int chunkX, int chunkY) {
+    uint64_t key = keyOf(chunkX, chunkY);
+    if (lastSlot >= 0 && pool[lastSlot].key == key) {
+        pool[lastSlot].lastUse = ++clock;
+        return pool[lastSlot];
+    }
+
+    std::unordered_map<uint64_t, int>::iterator found = resident.find(key);
+    if (found != resident.end()) {
+        lastSlot = found->second;
+        pool[lastSlot].lastUse = ++clock;
+        return pool[lastSlot];
+    }
+
+    // Take a free slot, or evict the least recently used chunk
+    int slot;
+    if (pool.size() < pool.capacity()) {
+        pool.push_back(Chunk());
+        slot = static_cast<int>(pool.size()) - 1;
+    } else {
+        slot = 0;
+        for (size_t i = 1; i < pool.size(); ++i) {
+            if (pool[i].lastUse < pool[slot].lastUse) {
+                slot = static_cast<int>(i);
+            }
+        }
+        evict(pool[slot]);
+        resident.erase(pool[slot].key);
+    }
+
+    Chunk &chunk = pool[slot];
+    std::memset(chunk.cells, 0, sizeof(chunk.cells));
+    chunk.key = key;
+    chunk.lastUse = ++clock;
+    chunk.touched = false;
+    restore(chunk);
+    generate(chunk, chunkX, chunkY);
+    resident[key] = slot;
+    lastSlot = slot;
+    return chunk;
+}
+
+
+// Hashes the mines of the chunk and its border into the halo, then counts neighbours 64 cells at a time
+void EndlessBoard::generate(Chunk &chunk, int chunkX, int chunkY) {
+    PERF_SCOPE("chunk generation");
+    int left = chunkX * ChunkSize - 1;
+    int top = chunkY * ChunkSize - 1;
+    halo.clear();
+    for (int r = 0; r < ChunkSize + 2; ++r) {
+        for (int c = 0; c < ChunkSize + 2; ++c) {
+            if (isMine(left + c, top + r)) {
+                halo.set(r, c);
+            }
+        }
+    }
+    halo.neighbourCounts(countPlanes);
+
+    // Columns 1 to 64 of each halo row hold the chunk row, shifted out of two words
+    for (int r = 0; r < ChunkSize; ++r) {
+        uint64_t planes[5];
+        for (int i = 0; i < 4; ++i) {
+            const uint64_t *row = countPlanes[i].rowData(r + 1);
+            planes[i] = (row[0] >> 1) | (row[1] << 63);
+        }
+        const uint64_t *mines = halo.rowData(r + 1);
+        planes[4] = (mines[0] >> 1) | (mines[1] << 63);
+
+        unsigned char *cells = &chunk.cells[r * ChunkSize];
+        for (int c = 0; c < ChunkSize; ++c) {
+            unsigned char bits = static_cast<unsigned char>(((planes[0] >> c) & 1) | (((planes[1] >> c) & 1) << 1) |
+                                                            (((planes[2] >> c) & 1) << 2) | (((planes[3] >> c) & 1) << 3) |
+                                                            (((planes[4] >> c) & 1) << 4));  // Count plus Board::MineBit
+            cells[c] = (cells[c] & (Board::RevealedBit | Board::FlaggedBit)) | bits;
+        }
+    }
+}
+
+
+// Packs the revealed and flagged bits as 128 words: two masks mark the all-zero and all-one words, only the others
+// are stored literally, so opened areas and untouched rows cost next to nothing
+void EndlessBoard::evict(Chunk &chunk) {
+    if (!chunk.touched) {
+        return;  // Everything in it can be regenerated from the seed
+    }
+
+    uint64_t words[2 * ChunkSize];
+    for (int r = 0; r < ChunkSize; ++r) {
+        uint64_t revealed = 0, flagged = 0;
+        for (int c = 0; c < ChunkSize; ++c) {
+            unsigned char cell = chunk.cells[r * ChunkSize + c];
+            revealed |= static_cast<uint64_t>((cell & Board::RevealedBit) != 0) << c;
+            flagged |= static_cast<uint64_t>((cell & Board::FlaggedBit) != 0) << c;
+        }
+        words[r] = revealed;
+        words[ChunkSize + r] = flagged;
+    }
+
+    std::vector<uint64_t> &packed = store[chunk.key];
+    packed.assign(4, 0);  // Zero mask and full mask, two words each
+    for (int i = 0; i < 2 * ChunkSize; ++i) {
+        if (words[i] == 0) {
+            packed[i >> 6] |= uint64_t(1) << (i & 63);
+        } else if (words[i] == ~uint64_t(0)) {
+            packed[2 + (i >> 6)] |= uint64_t(1) << (i & 63);
+        } else {
+            packed.push_back(words[i]);
+        }
+    }
+    packed.shrink_to_fit();
+}
+
+
+void EndlessBoard::restore(Chunk &chunk) {
+    std::unordered_map<uint64_t, std::vector<uint64_t> >::iterator found = store.find(chunk.key);
+    if (found == store.end()) {
+        return;
+    }
+
+    const std::vector<uint64_t> &packed = found->second;
+    size_t literal = 4;
+    for (int i = 0; i < 2 * ChunkSize; ++i) {
+        uint64_t word;
+        if ((packed[i >> 6] >> (i & 63)) & 1) {
+            word = 0;
+        } else if ((packed[2 + (i >> 6)] >> (i & 63)) & 1) {
+            word = ~uint64_t(0);
+        } else {
+            word = packed[literal++];
+        }
+        unsigned char bit = i < ChunkSize ? Board::RevealedBit : Board::FlaggedBit;
+        unsigned char *row = &chunk.cells[(i & (ChunkSize - 1)) * ChunkSize];
+        for (int c = 0; c < ChunkSize; ++c) {
+            if ((word >> c) & 1) {
+                row[c] |= bit;
+            }
+        }
+    }
+    chunk.touched = true;
+    store.erase(found);  // The resident copy is the only one until it is evicted again
+}
+
+
+// Same rules as Board::revealCell, except that a cascade larger than floodLimit is finished by continueReveal()
+int EndlessBoard::revealCell(int x, int y) {
+    if (gameState != Board::Playing || isRevealed(x, y)) {
+        return 0;
+    }
+    if (!started) {
+        // The first cell and its neighbours become safe, so the counts of every chunk generated so far change
+        started = true;
+        safeX = x;
+        safeY = y;
+        for (size_t i = 0; i < pool.size(); ++i) {
+            generate(pool[i], static_cast<int>(pool[i].key >> 32), static_cast<int>(static_cast<uint32_t>(pool[i].key)));
+        }
+    }
+    if (isMine(x, y)) {
+        gameState = Board::Lost;
+        return 0;
+    }
+
+    uint64_t before = numRevealed;
+    reveal(x, y);
+    flood(floodLimit);
+    return static_cast<int>(numRevealed - before);
+}
+
+
+// Same rules as Board::chordCell, the flood from the neighbours shares one queue and one limit
+int EndlessBoard::chordCell(int x, int y) {
+    if (gameState != Board::Playing || !isRevealed(x, y)) {
+        return 0;
+    }
+    int flags = 0;
+    for (int dy = -1; dy <= 1; ++dy) {
+        for (int dx = -1; dx <= 1; ++dx) {
+            flags += isFlagged(x + dx, y + dy);
+        }
+    }
+    if (flags != adjacentMines(x, y)) {
+        return 0;
+    }
+
+    for (int dy = -1; dy <= 1; ++dy) {
+        for (int dx = -1; dx <= 1; ++dx) {
+            unsigned char cell = cellAt(x + dx, y + dy);
+            if (!(cell & (Board::RevealedBit | Board::FlaggedBit)) && (cell & Board::MineBit)) {
+                gameState = Board::Lost;
+                return 0;
+            }
+        }
+    }
+    uint64_t before = numRevealed;
+    for (int dy = -1; dy <= 1; ++dy) {
+        for (int dx = -1; dx <= 1; ++dx) {
+            if (!(cellAt(x + dx, y + dy) & (Board::RevealedBit | Board::FlaggedBit))) {
+                reveal(x + dx, y + dy);
+            }
+        }
+    }
+    flood(floodLimit);
+    return static_cast<int>(numRevealed - before);
+}
+
+
+int EndlessBoard::continueReveal() {
+    uint64_t before = numRevealed;
+    flood(floodLimit);
+    return static_cast<int>(numRevealed - before);
+}
+
+
+void EndlessBoard::reveal(int x, int y) {
+    Chunk &chunk = chunkAt(chunkOf(x), chunkOf(y));
+    unsigned char &cell = chunk.cells[(y & (ChunkSize - 1)) * ChunkSize + (x & (ChunkSize - 1))];
+    cell = (cell & ~Board::FlaggedBit) | Board::RevealedBit;
+    chunk.touched = true;
+    numRevealed++;
+    if ((cell & Board::CountMask) == 0) {
+        Position position = { x, y };
+        floodQueue.push_back(position);  // Its neighbours are revealed when the queue reaches it
+    }
+}
+
+
+// Breadth-first like Board::revealAdjacentCells, crossing chunk borders through the global coordinates
+int EndlessBoard::flood(int limit) {
+    PERF_SCOPE("endless flood");
+    uint64_t before = numRevealed;
+    while (floodHead < floodQueue.size() && numRevealed - before < static_cast<uint64_t>(limit)) {
+        Position position = floodQueue[floodHead++];
+        for (int dy = -1; dy <= 1; ++dy) {
+            for (int dx = -1; dx <= 1; ++dx) {
+                if (!(cellAt(position.x + dx, position.y + dy) & Board::RevealedBit)) {  // Neighbours of a zero are never mines
+                    reveal(position.x + dx, position.y + dy);
+                }
+            }
+        }
+    }
+    PERF_COUNT("cells revealed", numRevealed - before);
+    if (floodHead == floodQueue.size()) {
+        floodQueue.clear();
+        floodHead = 0;
+    }
+    return static_cast<int>(numRevealed - before);
+}
+
+
+bool EndlessBoard::markCell(int x, int y) {
+    if (gameState != Board::Playing) {
+        return false;
+    }
+    Chunk &chunk = chunkAt(chunkOf(x), chunkOf(y));
+    unsigned char &cell = chunk.cells[(y & (ChunkSize - 1)) * ChunkSize + (x & (ChunkSize - 1))];
+    if (cell & Board::RevealedBit) {
+        return false;
+    }
+    cell ^= Board::FlaggedBit;
+    chunk.touched = true;
+    return true;
+}
+
+
+size_t EndlessBoard::storedBytes() const {
+    size_t bytes = 0;
+    for (std::unordered_map<uint64_t, std::vector<uint64_t> >::const_iterator it = store.begin(); it != store.end(); ++it) {
+        bytes += it->second.size() * sizeof(uint64_t);
+    }
+    return bytes;
+}
@@ -0,0 +1,84 @@
+#ifndef ENDLESS_H
+#define ENDLESS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "board.h"
+
+// Unbounded minefield for the endless mode, addressed by signed (x, y) cell coordinates
+// Whether a cell holds a mine is a pure hash of the seed and its coordinates, so any cell can be regenerated at any
+// time and neighbouring chunks always agree on the mines along their shared border
+// The field is split into 64x64 chunks of Board-style cell bytes; a fixed pool keeps the most recently used ones,
+// and evicted chunks keep only their revealed and flagged bits, run-length packed, while untouched chunks are dropped,
+// so memory grows with the area the player has opened rather than with how far the view has scrolled
+class EndlessBoard {
+public:
+    enum {
+        ChunkShift = 6,  // Chunks are 2^ChunkShift cells on a side
+        ChunkSize = 1 << ChunkShift,
+        ChunkCells = ChunkSize * ChunkSize
+    };
+
+    EndlessBoard();
+
+    void setupGame(uint64_t seed, double density, int residentChunks = 256);  // Resets the field, the first reveal is always safe
+    int revealCell(int x, int y);  // Reveals a cell and flood-fills around zeros, returns how many cells it revealed
+    int chordCell(int x, int y);  // Reveals the unflagged neighbours of a satisfied number, returns how many cells it revealed
+    int continueReveal();  // Carries on a flood fill that hit the per-call limit, returns how many cells it revealed
+    bool revealPending() const { return floodHead < floodQueue.size(); }
+    bool markCell(int x, int y);  // Toggles the flag on a hidden cell, returns whether it changed
+
+    bool isMine(int x, int y) const;  // Pure function of the seed and the coordinates
+    bool isRevealed(int x, int y) { return cellAt(x, y) & Board::RevealedBit; }
+    bool isFlagged(int x, int y) { return cellAt(x, y) & Board::FlaggedBit; }
+    int adjacentMines(int x, int y) { return cellAt(x, y) & Board::CountMask; }
+    unsigned char cellAt(int x, int y);  // Packed cell state, loads the chunk if needed
+
+    Board::State state() const { return gameState; }
+    uint64_t revealedCount() const { return numRevealed; }
+    size_t residentChunks() const { return resident.size(); }
+    size_t storedChunks() const { return store.size(); }
+    size_t storedBytes() const;  // Size of the packed store
+
+private:
+    struct Chunk {
+        unsigned char cells[ChunkCells];  // Same layout and bits as Board cells
+        uint64_t key;  // Packed chunk coordinates
+        uint64_t lastUse;  // Access stamp for least-recently-used eviction
+        bool touched;  // Whether any cell was revealed or flagged, untouched chunks are regenerated instead of stored
+    };
+
+    static int chunkOf(int coordinate) { return coordinate >= 0 ? coordinate >> ChunkShift : ~((~coordinate) >> ChunkShift); }
+    static uint64_t keyOf(int chunkX, int chunkY) { return (static_cast<uint64_t>(static_cast<uint32_t>(chunkX)) << 32) | static_cast<uint32_t>(chunkY); }
+
+    Chunk &chunkAt(int chunkX, int chunkY);  // Returns a resident chunk, evicting and loading as needed
+    void generate(Chunk &chunk, int chunkX, int chunkY);  // Fills in mines and counts, keeping the state bits
+    void evict(Chunk &chunk);  // Packs the state of a touched chunk into the store
+    void restore(Chunk &chunk);  // Unpacks the stored state of a chunk, if any
+    int flood(int limit);  // Processes the flood queue until it is empty or limit cells were revealed
+    void reveal(int x, int y);  // Marks a cell revealed and queues it
+
+    struct Position {
+        int x, y;
+    };
+
+    std::vector<Chunk> pool;  // Resident chunks, never more than the limit given to setupGame
+    std::unordered_map<uint64_t, int> resident;  // Chunk key to pool slot
+    std::unordered_map<uint64_t, std::vector<uint64_t> > store;  // Packed state of evicted touched chunks
+    std::vector<Position> floodQueue;  // Revealed zero cells whose neighbours are still to be revealed
+    size_t floodHead;  // First unprocessed entry of floodQueue
+    BitGrid halo;  // Mines of a chunk plus a one cell border, scratch for generate()
+    BitGrid countPlanes[4];  // Scratch planes for the neighbour count kernel
+    uint64_t gameSeed;  // Seed the mines are derived from
+    uint64_t threshold;  // Hash values below it are mines
+    uint64_t clock;  // Access counter for lastUse
+    uint64_t numRevealed;  // Safe cells revealed so far
+    int lastSlot;  // Pool slot of the last chunk looked up, most lookups hit the same chunk
+    int safeX, safeY;  // First revealed cell, it and its neighbours are never mines
+    bool started;  // Whether the first cell has been revealed
+    Board::State gameState;  // Playing or Lost, the endless mode cannot be won
+};
+
+#endif // ENDLESS_H
@@ -0,0 +1,127 @@
+#include "endlessview.h"
+
+#include <QPainter>
+#include "perf.h"
+
+EndlessView::EndlessView(EndlessBoard *board, const IconAtlas *icons, QWidget *parent)
+    : QWidget(parent), board(board), icons(icons), originX(0), originY(0) {
+    setAttribute(Qt::WA_OpaquePaintEvent);  // Every pixel is covered by a tile
+    setFocusPolicy(Qt::StrongFocus);  // Needed for the arrow keys
+}
+
+
+QSize EndlessView::sizeHint() const {
+    QSize cell = icons->tileSize();
+    return QSize(30 * cell.width(), 16 * cell.height());  // Expert sized by default, the field itself has no size
+}
+
+
+int EndlessView::floorDiv(int64_t value, int divisor) {
+    int64_t quotient = value / divisor;
+    if (value % divisor != 0 && value < 0) {
+        quotient--;
+    }
+    return static_cast<int>(quotient);
+}
+
+
+void EndlessView::centerOn(int x, int y) {
+    QSize cell = icons->tileSize();
+    originX = static_cast<int64_t>(x) * cell.width() + cell.width() / 2 - width() / 2;
+    originY = static_cast<int64_t>(y) * cell.height() + cell.height() / 2 - height() / 2;
+    update();
+}
+
+
+void EndlessView::pan(int dx, int dy) {
+    originX += dx;
+    originY += dy;
+    scroll(-dx, -dy);  // Qt moves the pixels already drawn and only repaints the uncovered strips
+}
+
+
+// Same rules as BoardView::tileAt
+int EndlessView::tileAt(int x, int y) const {
+    unsigned char cell = board->cellAt(x, y);
+    if (cell & Board::RevealedBit) {
+        return cell & Board::CountMask;
+    }
+    if (board->state() != Board::Playing && (cell & Board::MineBit)) {
+        return IconAtlas::Mine;
+    }
+    if (cell & Board::FlaggedBit) {
+        return IconAtlas::Flag;
+    }
+    return IconAtlas::Empty;
+}
+
+
+void EndlessView::paintEvent(QPaintEvent *event) {
+    PERF_FRAME();
+    QPainter painter(this);
+    QSize cell = icons->tileSize();
+    QRect dirty = event->rect();
+
+    int firstX = floorDiv(originX + dirty.left(), cell.width());
+    int lastX = floorDiv(originX + dirty.right(), cell.width());
+    int firstY = floorDiv(originY + dirty.top(), cell.height());
+    int lastY = floorDiv(originY + dirty.bottom(), cell.height());
+    PERF_COUNT("icons drawn", static_cast<int64_t>(lastX - firstX + 1) * (lastY - firstY + 1));
+
+    for (int y = firstY; y <= lastY; ++y) {
+        for (int x = firstX; x <= lastX; ++x) {
+            int left = static_cast<int>(static_cast<int64_t>(x) * cell.width() - originX);
+            int top = static_cast<int>(static_cast<int64_t>(y) * cell.height() - originY);
+            painter.drawPixmap(left, top, icons->pixmap(tileAt(x, y)));
+        }
+    }
+}
+
+
+void EndlessView::mousePressEvent(QMouseEvent *event) {
+    QSize cell = icons->tileSize();
+    int x = floorDiv(originX + event->pos().x(), cell.width());
+    int y = floorDiv(originY + event->pos().y(), cell.height());
+
+    if (event->button() == Qt::LeftButton) {
+        emit cellClicked(x, y);
+    }
+    else if (event->button() == Qt::RightButton) {
+        emit cellMarked(x, y);
+    }
+    else if (event->button() == Qt::MiddleButton) {
+        dragStart = event->pos();
+    }
+}
+
+
+void EndlessView::mouseMoveEvent(QMouseEvent *event) {
+    if (event->buttons() & Qt::MiddleButton) {
+        QPoint delta = event->pos() - dragStart;
+        dragStart = event->pos();
+        pan(-delta.x(), -delta.y());
+    }
+}
+
+
+void EndlessView::wheelEvent(QWheelEvent *event) {
+    QPoint delta = event->angleDelta() / 4;  // 120 units per notch, 30 pixels
+    if (event->modifiers() & Qt::ShiftModifier) {
+        pan(-delta.y(), 0);
+    } else {
+        pan(-delta.x(), -delta.y());
+    }
+    event->accept();
+}
+
+
+void EndlessView::keyPressEvent(QKeyEvent *event) {
+    QSize cell = icons->tileSize();
+    switch (event->key()) {
+    case Qt::Key_Left: pan(-cell.width(), 0); break;
+    case Qt::Key_Right: pan(cell.width(), 0); break;
+    case Qt::Key_Up: pan(0, -cell.height()); break;
+    case Qt::Key_Down: pan(0, cell.height()); break;
+    default: QWidget::keyPressEvent(event); break;
+    }
+}
@@ -0,0 +1,46 @@
+#ifndef ENDLESSVIEW_H
+#define ENDLESSVIEW_H
+
+#include <QWidget>
+#include <QKeyEvent>
+#include <QMouseEvent>
+#include <QPaintEvent>
+#include <QWheelEvent>
+#include "endless.h"
+#include "iconatlas.h"
+
+// Draws the part of an endless minefield under a movable viewport, in the same way BoardView draws a finite board
+// The viewport pans with the mouse wheel, the arrow keys or by dragging with the middle button
+// Only the visible cells are read, so only the chunks around the viewport stay resident
+class EndlessView : public QWidget {
+    Q_OBJECT
+
+public:
+    EndlessView(EndlessBoard *board, const IconAtlas *icons, QWidget *parent = nullptr);
+
+    QSize sizeHint() const override;
+    void centerOn(int x, int y);  // Scrolls so that the cell is in the middle of the widget
+
+signals:
+    void cellClicked(int x, int y);  // Emitted when a cell is left-clicked
+    void cellMarked(int x, int y);  // Emitted when a cell is right-clicked
+
+protected:
+    void paintEvent(QPaintEvent *event) override;  // Paints the cells inside the dirty region
+    void mousePressEvent(QMouseEvent *event) override;  // Converts the click position to a cell, or starts a drag
+    void mouseMoveEvent(QMouseEvent *event) override;  // Pans while the middle button is held
+    void wheelEvent(QWheelEvent *event) override;  // Pans with the wheel, horizontally with Shift held
+    void keyPressEvent(QKeyEvent *event) override;  // Pans one cell per arrow key press
+
+private:
+    void pan(int dx, int dy);  // Moves the viewport by a number of pixels
+    int tileAt(int x, int y) const;  // Picks the atlas tile describing a cell
+    static int floorDiv(int64_t value, int divisor);  // Division rounding towards negative infinity
+
+    EndlessBoard *board;  // Engine being displayed, owned by the main window; reading cells may load chunks
+    const IconAtlas *icons;  // Shared cell images, owned by the main window
+    int64_t originX, originY;  // Field position of the widget's top left corner, in pixels
+    QPoint dragStart;  // Last mouse position of a middle-button drag
+};
+
+#endif // ENDLESSVIEW_H
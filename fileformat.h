@@ -0,0 +1,15 @@
+#ifndef FILEFORMAT_H
+#define FILEFORMAT_H
+
+#include <cstdint>
+
+// Shared by every binary file the game writes: saved games, puzzle archives and replays
+const uint32_t fileFormatVersion = 1;  // Bump when a layout changes, older files are then rejected
+const int maxFileCells = 1 << 28;  // Sanity limit for sizes read from a file
+
+// Whether a size read from a file describes a board the engine can set up
+inline bool validFileSize(int64_t rows, int64_t columns) {
+    return rows > 0 && columns > 0 && rows * columns <= maxFileCells;
+}
+
+#endif // FILEFORMAT_H
@@ -0,0 +1,258 @@
+#include "gamefile.h"
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include "fileformat.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+struct SaveHeader {
+    char magic[8];  // "MSWPSAVE"
+    uint32_t version;
+    uint32_t rows;
+    uint32_t columns;
+    uint32_t mines;
+    uint64_t seed;
+    uint32_t state;  // Board::State
+    uint32_t placed;  // Whether the mine layer is present
+};
+
+struct ArchiveHeader {
+    char magic[8];  // "MSWPPUZL"
+    uint32_t version;
+    uint32_t rows;
+    uint32_t columns;
+    uint32_t mines;
+    uint64_t count;  // Number of records that follow
+};
+
+static_assert(sizeof(SaveHeader) == 40 && sizeof(ArchiveHeader) == 32, "File headers must not contain padding");
+
+}
+
+
+bool GameFile::save(const Board &board, const std::string &path) {
+    SaveHeader header;
+    std::memcpy(header.magic, "MSWPSAVE", 8);
+    header.version = fileFormatVersion;
+    header.rows = board.rows();
+    header.columns = board.columns();
+    header.mines = board.mineCount();
+    header.seed = board.seed();
+    header.state = board.state();
+    header.placed = board.minesPlaced();
+
+    std::FILE *file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+    std::vector<uint64_t> layer(board.revealedBits().packedWords());
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1;
+    if (ok && board.minesPlaced()) {
+        board.mineBits().pack(layer.data());
+        ok = std::fwrite(layer.data(), sizeof(uint64_t), layer.size(), file) == layer.size();
+    }
+    if (ok) {
+        board.revealedBits().pack(layer.data());
+        ok = std::fwrite(layer.data(), sizeof(uint64_t), layer.size(), file) == layer.size();
+    }
+    if (ok) {
+        board.flaggedBits().pack(layer.data());
+        ok = std::fwrite(layer.data(), sizeof(uint64_t), layer.size(), file) == layer.size();
+    }
+    return std::fclose(file) == 0 && ok;
+}
+
+
+bool GameFile::load(Board &board, const std::string &path) {
+    std::FILE *file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        return false;
+    }
+
+    SaveHeader header;
+    bool ok = std::fread(&header, sizeof(header), 1, file) == 1 && std::memcmp(header.magic, "MSWPSAVE", 8) == 0 &&
+              header.version == fileFormatVersion && validFileSize(header.rows, header.columns) &&
+              header.mines < header.rows * header.columns && header.state <= Board::Lost;
+
+    // Read every layer before touching the board, so a truncated file leaves the current game intact
+    size_t words = (static_cast<size_t>(header.rows) * header.columns + 63) / 64;
+    std::vector<uint64_t> layers;
+    if (ok) {
+        layers.resize(3 * words);
+        ok = (!header.placed || std::fread(&layers[0], sizeof(uint64_t), words, file) == words) &&
+             std::fread(&layers[words], sizeof(uint64_t), words, file) == words &&
+             std::fread(&layers[2 * words], sizeof(uint64_t), words, file) == words;
+    }
+    std::fclose(file);
+    if (!ok) {
+        return false;
+    }
+
+    board.setupGame(header.rows, header.columns, header.mines, header.seed);
+    if (header.placed) {
+        board.setMineBits(&layers[0]);
+    }
+    board.restoreProgress(&layers[words], &layers[2 * words], static_cast<Board::State>(header.state));
+    return true;
+}
+
+
+PuzzleArchive::PuzzleArchive()
+    : data(nullptr), size(0), mapping(nullptr), rowCount(0), columnCount(0), mineCount(0), puzzleCount(0), stride(0) {
+}
+
+
+PuzzleArchive::~PuzzleArchive() {
+    close();
+}
+
+
+// Maps the whole file read-only; pages are only read from disk when a puzzle on them is used
+bool PuzzleArchive::open(const std::string &path) {
+    close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER length;
+    HANDLE handle = GetFileSizeEx(file, &length) ? CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr) : nullptr;
+    CloseHandle(file);  // The mapping keeps the file open
+    if (!handle) {
+        return false;
+    }
+    void *view = MapViewOfFile(handle, FILE_MAP_READ, 0, 0, 0);
+    if (!view) {
+        CloseHandle(handle);
+        return false;
+    }
+    data = static_cast<const unsigned char *>(view);
+    size = static_cast<size_t>(length.QuadPart);
+    mapping = handle;
+#else
+    int file = ::open(path.c_str(), O_RDONLY);
+    if (file < 0) {
+        return false;
+    }
+    struct stat status;
+    void *view = fstat(file, &status) == 0 && status.st_size > 0
+                     ? mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_SHARED, file, 0)
+                     : MAP_FAILED;
+    ::close(file);  // The mapping keeps the file open
+    if (view == MAP_FAILED) {
+        return false;
+    }
+    madvise(view, static_cast<size_t>(status.st_size), MADV_RANDOM);  // Puzzles are picked by number, no read-ahead
+    data = static_cast<const unsigned char *>(view);
+    size = static_cast<size_t>(status.st_size);
+#endif
+
+    ArchiveHeader header;
+    bool ok = size >= sizeof(header);
+    if (ok) {
+        std::memcpy(&header, data, sizeof(header));
+        ok = std::memcmp(header.magic, "MSWPPUZL", 8) == 0 && header.version == fileFormatVersion &&
+             validFileSize(header.rows, header.columns) && header.mines < header.rows * header.columns;
+    }
+    if (ok) {
+        stride = recordWords(header.rows, header.columns);
+        ok = header.count <= (size - sizeof(header)) / (stride * sizeof(uint64_t));  // Every record is inside the file
+    }
+    if (!ok) {
+        close();
+        return false;
+    }
+
+    rowCount = header.rows;
+    columnCount = header.columns;
+    mineCount = header.mines;
+    puzzleCount = header.count;
+    return true;
+}
+
+
+void PuzzleArchive::close() {
+    if (!data) {
+        return;
+    }
+#ifdef _WIN32
+    UnmapViewOfFile(data);
+    CloseHandle(static_cast<HANDLE>(mapping));
+#else
+    munmap(const_cast<unsigned char *>(data), size);
+#endif
+    data = nullptr;
+    size = 0;
+    mapping = nullptr;
+    puzzleCount = 0;
+}
+
+
+// Record layout: seed, first cell in the low half and flags in the high half of the second word, then the mine layer
+PuzzleArchive::Puzzle PuzzleArchive::puzzle(uint64_t number) const {
+    const uint64_t *record = reinterpret_cast<const uint64_t *>(data + sizeof(ArchiveHeader)) + number * stride;
+    Puzzle puzzle;
+    puzzle.seed = record[0];
+    uint32_t first = static_cast<uint32_t>(record[1]);
+    // open() only checks the header and the size, a damaged record must not send a reveal outside the board
+    puzzle.firstCell = first < static_cast<uint64_t>(rowCount) * columnCount ? static_cast<int>(first) : -1;
+    puzzle.noGuess = (record[1] >> 32) & 1;
+    puzzle.mines = record + 2;
+    return puzzle;
+}
+
+
+bool PuzzleArchive::load(Board &board, uint64_t number) const {
+    Puzzle entry = puzzle(number);
+    if (entry.firstCell < 0) {
+        return false;
+    }
+    board.setupGame(rowCount, columnCount, mineCount, entry.seed);
+    board.setMineBits(entry.mines);
+    return true;
+}
+
+
+size_t PuzzleArchive::recordWords(int rows, int columns) {
+    return 2 + (static_cast<size_t>(rows) * columns + 63) / 64;
+}
+
+
+void PuzzleArchive::packRecord(const Board &board, int firstCell, bool noGuess, uint64_t *record) {
+    record[0] = board.seed();
+    record[1] = static_cast<uint32_t>(firstCell) | (static_cast<uint64_t>(noGuess) << 32);
+    board.mineBits().pack(record + 2);
+}
+
+
+bool PuzzleArchive::write(const std::string &path, int rows, int columns, int mines, const uint64_t *records,
+                          uint64_t count) {
+    ArchiveHeader header;
+    std::memcpy(header.magic, "MSWPPUZL", 8);
+    header.version = fileFormatVersion;
+    header.rows = rows;
+    header.columns = columns;
+    header.mines = mines;
+    header.count = count;
+
+    std::FILE *file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+    size_t words = static_cast<size_t>(count) * recordWords(rows, columns);
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+              std::fwrite(records, sizeof(uint64_t), words, file) == words;
+    return std::fclose(file) == 0 && ok;
+}
@@ -0,0 +1,63 @@
+#ifndef GAMEFILE_H
+#define GAMEFILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "board.h"
+
+// Versioned binary files for saved games and puzzle archives
+// Every layer is a BitGrid::pack() bit stream of rows * columns bits, so a layer loads with word copies and no parsing;
+// all values are little-endian, as written by every platform the game builds on
+
+// Saved game: a fixed header with the size, seed and state, then the mine layer (when mines were placed),
+// the revealed layer and the flag layer
+class GameFile {
+public:
+    static bool save(const Board &board, const std::string &path);  // Returns false if the file could not be written
+    static bool load(Board &board, const std::string &path);  // Returns false and leaves the board alone on any error
+};
+
+// Read-only archive of pre-generated boards of one size, memory-mapped and indexed by puzzle number
+// Records have a fixed size, so puzzle n is found by arithmetic and its mine layer is read straight from the mapping
+class PuzzleArchive {
+public:
+    struct Puzzle {
+        uint64_t seed;  // Seed the board was generated from, for a no-guess board the one of the winning attempt
+        int firstCell;  // Cell the board was generated around, reveal it to start; -1 if the record is malformed
+        bool noGuess;  // Whether the board was verified to need no guess
+        const uint64_t *mines;  // Packed mine layer inside the mapping, valid while the archive is open
+    };
+
+    PuzzleArchive();
+    ~PuzzleArchive();
+
+    bool open(const std::string &path);  // Maps the archive, returns false if it is missing or malformed
+    void close();
+    bool isOpen() const { return data != nullptr; }
+
+    int rows() const { return rowCount; }
+    int columns() const { return columnCount; }
+    int mines() const { return mineCount; }
+    uint64_t count() const { return puzzleCount; }
+    Puzzle puzzle(uint64_t number) const;  // number must be below count()
+    bool load(Board &board, uint64_t number) const;  // Sets the board up with the puzzle's layout, false if it is malformed
+
+    static size_t recordWords(int rows, int columns);  // Size of one record in 64-bit words
+    static void packRecord(const Board &board, int firstCell, bool noGuess, uint64_t *record);  // Board must have its mines
+    static bool write(const std::string &path, int rows, int columns, int mines, const uint64_t *records,
+                      uint64_t count);  // Writes the header followed by count records
+
+private:
+    PuzzleArchive(const PuzzleArchive &);  // Owns a mapping, not copyable
+    PuzzleArchive &operator=(const PuzzleArchive &);
+
+    const unsigned char *data;  // Start of the mapping
+    size_t size;  // Length of the mapping in bytes
+    void *mapping;  // Platform handle of the mapping, only used on Windows
+    int rowCount, columnCount, mineCount;  // Size of every board in the archive
+    uint64_t puzzleCount;  // Number of records
+    size_t stride;  // Words per record
+};
+
+#endif // GAMEFILE_H
@@ -0,0 +1,261 @@
+#include "generator.h"
+
+#include <algorithm>
+#include "perf.h"
+#include "rng.h"
+
+static const uint32_t noAttempt = 0xFFFFFFFFu;  // bestAttempt before any attempt passed
+
+NoGuessGenerator::Result NoGuessGenerator::generate(int rows, int columns, int mines, uint64_t seed, int row, int col,
+                                                    double budgetMs, int threads) {
+    PERF_SCOPE("no-guess generation");
+    rowCount = rows;
+    columnCount = columns;
+    mineCount = mines;
+    firstRow = row;
+    firstCol = col;
+    baseSeed = seed;
+
+    Clock::time_point start = Clock::now();
+    std::chrono::microseconds budget(static_cast<int64_t>(budgetMs * 1000.0));
+    searchDeadline = start + budget / 2;  // The other half is left for the repair fallback
+    deadline = start + budget;
+    nextAttempt.store(0);
+    bestAttempt.store(noAttempt);
+
+    size_t count = threads > 0 ? threads : std::min<size_t>(8, WorkerPool<Worker>::threadCount(0));
+    workers.resize(count);
+    for (size_t t = 0; t < count; ++t) {
+        workers[t].furthestAttempt = noAttempt;
+        workers[t].furthestRevealed = -1;
+        workers[t].attempts = 0;
+    }
+    workers.run(count, [this](size_t t) { search(workers[t]); });
+
+    Result result;
+    result.attempts = 0;
+    for (size_t t = 0; t < count; ++t) {
+        result.attempts += workers[t].attempts;
+    }
+    result.repaired = false;
+    if (bestAttempt.load() != noAttempt) {
+        result.seed = attemptSeed(bestAttempt.load());
+        layoutOf(workers[0].board, bestAttempt.load(), result.mines);
+        result.solvable = true;
+        return result;
+    }
+
+    // No candidate passed in time, repair the one that got furthest
+    uint32_t furthest = 0;
+    int revealed = -1;
+    for (size_t t = 0; t < count; ++t) {
+        const Worker &worker = workers[t];
+        if (worker.furthestRevealed > revealed ||
+            (worker.furthestRevealed == revealed && worker.furthestAttempt < furthest)) {
+            furthest = worker.furthestAttempt;
+            revealed = worker.furthestRevealed;
+        }
+    }
+    result.seed = attemptSeed(furthest);
+    layoutOf(workers[0].board, furthest, result.mines);
+    result.repaired = true;
+    result.solvable = repair(workers[0], result.mines);
+    return result;
+}
+
+
+void NoGuessGenerator::search(Worker &worker) {
+    while (Clock::now() < searchDeadline) {
+        uint32_t attempt = nextAttempt.fetch_add(1);
+        if (attempt > bestAttempt.load(std::memory_order_relaxed)) {
+            return;  // A lower attempt already passed, so this one could never be chosen
+        }
+
+        worker.attempts++;
+        worker.board.setupGame(rowCount, columnCount, mineCount, attemptSeed(attempt));
+        if (playOut(worker, attempt, searchDeadline)) {
+            uint32_t best = bestAttempt.load();
+            while (attempt < best && !bestAttempt.compare_exchange_weak(best, attempt)) {
+            }
+            return;
+        }
+        if (worker.board.revealedCount() > worker.furthestRevealed) {
+            worker.furthestRevealed = worker.board.revealedCount();
+            worker.furthestAttempt = attempt;
+        }
+    }
+}
+
+
+bool NoGuessGenerator::playOut(Worker &worker, uint32_t attempt, Clock::time_point limit) {
+    worker.solver.reset(worker.board);
+    return solveFrom(worker, worker.board.index(firstRow, firstCol), attempt, limit);
+}
+
+
+// Reveals the cell, then keeps revealing provably safe cells
+bool NoGuessGenerator::solveFrom(Worker &worker, int cell, uint32_t attempt, Clock::time_point limit) {
+    Board &board = worker.board;
+    Solver &solver = worker.solver;
+    while (true) {
+        const std::vector<int> &revealed = board.revealCell(board.rowOf(cell), board.columnOf(cell));
+        if (board.state() == Board::Won) {
+            return true;
+        }
+        if (attempt > bestAttempt.load(std::memory_order_relaxed) || Clock::now() >= limit) {
+            return false;  // Cancelled, either superseded or out of time
+        }
+        solver.update(board, revealed);
+        cell = solver.findSafeCell(board);
+        if (cell < 0) {
+            return false;  // Only a guess would get further
+        }
+    }
+}
+
+
+// Each time the solver gets stuck, the stuck number with the fewest unknown mines is emptied and solving continues in place
+// Its mines move to hidden cells that touch no revealed cell where possible, so the emptied number proves all of its
+// unknown neighbours safe and no other revealed number changes; near the end, when no free cell is left, the number
+// is filled with mines from elsewhere instead
+// Deductions made before a move may no longer follow from the new numbers, so a layout the in-place solve clears
+// is replayed from the first click, and repaired further from wherever that replay gets stuck
+bool NoGuessGenerator::repair(Worker &worker, std::vector<int> &layout) {
+    Board &board = worker.board;
+    Solver &solver = worker.solver;
+    Rng rng(baseSeed ^ 0xA5A5A5A5A5A5A5A5ULL);
+
+    while (Clock::now() < deadline) {
+        board.setupGame(rowCount, columnCount, mineCount, baseSeed);
+        board.setMines(layout);
+        if (playOut(worker, noAttempt, deadline)) {
+            return true;  // The replay from the first click passed
+        }
+
+        bool solved = false;
+        bool replay = false;  // Set when a deduced mine moved, the solver state no longer matches the board
+        while (!solved && !replay && board.state() == Board::Playing && Clock::now() < deadline) {
+            Solver::Constraint stuck;
+            stuck.size = 0;
+            stuck.mines = 9;
+            for (int cell : solver.frontier()) {
+                Solver::Constraint constraint = solver.constraintOf(board, cell);
+                if (constraint.size > 0 && constraint.mines < stuck.mines) {
+                    stuck = constraint;
+                }
+            }
+
+            if (stuck.size == 0) {
+                // The cells left touch no unresolved number, they are walled in by deduced mines: move one of those away
+                int wall = wallMine(board, solver);
+                int target = wall >= 0 ? pickCell(board, solver, rng, stuck, false) : -1;
+                if (target < 0) {
+                    return false;
+                }
+                board.moveMine(wall, target);
+                replay = true;
+                continue;
+            }
+
+            bool fill = pickCell(board, solver, rng, stuck, false) < 0;  // No free cell is left to empty the number into
+            for (int i = 0; i < stuck.size; ++i) {
+                int cell = stuck.unknown[i];
+                if (board.isMine(cell) == fill) {
+                    continue;
+                }
+                int other = pickCell(board, solver, rng, stuck, fill);
+                if (other < 0) {
+                    return false;  // The board is too dense to move anything
+                }
+                replay = replay || solver.isKnownMine(other);
+                if (fill) {
+                    board.moveMine(other, cell);
+                } else {
+                    board.moveMine(cell, other);
+                }
+                solver.update(board, std::vector<int>{cell, other});  // Re-examine the numbers around both ends
+            }
+            if (!replay) {
+                int cell = solver.findSafeCell(board);
+                solved = cell >= 0 && solveFrom(worker, cell, noAttempt, deadline);
+            }
+        }
+        if (!solved && !replay) {
+            return false;  // Out of time
+        }
+
+        layout.clear();
+        board.mineBits().forEach([&](int row, int col) { layout.push_back(board.index(row, col)); });
+    }
+    return false;
+}
+
+
+// Picks a hidden cell outside the stuck number, with or without a mine, preferring cells away from every revealed number
+// Cells the solver has deduced are only used when nothing else is left
+int NoGuessGenerator::pickCell(const Board &board, const Solver &solver, Rng &rng, const Solver::Constraint &stuck,
+                               bool mine) const {
+    const int tries = 64;
+    for (int i = 0; i < tries; ++i) {
+        int cell = static_cast<int>(rng.bounded(static_cast<uint32_t>(board.cellCount())));
+        if (board.isRevealed(cell) || board.isMine(cell) != mine) {
+            continue;
+        }
+        int neighbours[8];
+        int count = board.neighbours(cell, neighbours);
+        bool touchesRevealed = false;
+        for (int n = 0; n < count && !touchesRevealed; ++n) {
+            touchesRevealed = board.isRevealed(neighbours[n]);
+        }
+        if (!touchesRevealed) {
+            return cell;
+        }
+    }
+
+    // Late in the game the interior may be gone, then any other hidden cell will do and the replay sorts it out
+    int start = static_cast<int>(rng.bounded(static_cast<uint32_t>(board.cellCount())));
+    int deduced = -1;
+    for (int i = 0; i < board.cellCount(); ++i) {
+        int cell = (start + i) % board.cellCount();
+        if (board.isRevealed(cell) || board.isMine(cell) != mine ||
+            std::find(stuck.unknown, stuck.unknown + stuck.size, cell) != stuck.unknown + stuck.size) {
+            continue;
+        }
+        if (!solver.isKnownMine(cell)) {
+            return cell;
+        }
+        deduced = cell;
+    }
+    return deduced;
+}
+
+
+// Finds a deduced mine next to a hidden cell the solver knows nothing about
+int NoGuessGenerator::wallMine(const Board &board, const Solver &solver) const {
+    for (int cell = 0; cell < board.cellCount(); ++cell) {
+        if (board.isRevealed(cell) || solver.isKnownMine(cell)) {
+            continue;
+        }
+        int neighbours[8];
+        int count = board.neighbours(cell, neighbours);
+        for (int i = 0; i < count; ++i) {
+            if (solver.isKnownMine(neighbours[i])) {
+                return neighbours[i];
+            }
+        }
+    }
+    return -1;
+}
+
+
+void NoGuessGenerator::layoutOf(Board &board, uint32_t attempt, std::vector<int> &layout) const {
+    board.setupGame(rowCount, columnCount, mineCount, attemptSeed(attempt));
+    board.placeMines(firstRow, firstCol);
+    layout.clear();
+    board.mineBits().forEach([&](int row, int col) { layout.push_back(board.index(row, col)); });
+}
+
+
+uint64_t NoGuessGenerator::attemptSeed(uint32_t attempt) const {
+    return mixSeed(baseSeed + (static_cast<uint64_t>(attempt) + 1) * 0x9E3779B97F4A7C15ULL);
+}
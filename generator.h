@@ -0,0 +1,65 @@
+#ifndef GENERATOR_H
+#define GENERATOR_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+#include "board.h"
+#include "rng.h"
+#include "solver.h"
+#include "workerpool.h"
+
+// Generates layouts that the hint solver can clear from the first click without a single guess
+// Worker threads play candidate layouts derived from consecutive attempt numbers and the lowest passing attempt wins,
+// so among the attempts that finished, the result does not depend on which thread finished first
+// When the search runs out of its share of the budget, the most promising candidate is repaired instead:
+// mines are moved around each stuck number, preferably into the untouched interior, until the solver gets through
+// How many attempts finish in time and whether the repair runs depend on the machine and its load, so the game seed
+// does not reproduce the board; keep the returned layout, or the seed of the winning attempt for an unrepaired one
+class NoGuessGenerator {
+public:
+    struct Result {
+        std::vector<int> mines;  // Cells holding a mine
+        bool solvable;  // Whether the layout was shown to need no guess within the budget
+        bool repaired;  // Whether the layout came from the repair fallback
+        uint32_t attempts;  // Candidate layouts started by the search
+        uint64_t seed;  // Seed of the chosen attempt, setupGame() with it and a first reveal give the layout unless repaired
+    };
+
+    Result generate(int rows, int columns, int mines, uint64_t seed, int firstRow, int firstCol,
+                    double budgetMs, int threads = 0);  // Returns a layout that keeps (firstRow, firstCol) and its neighbours safe
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    // Engine instances owned by one thread
+    struct Worker {
+        Board board;
+        Solver solver;
+        uint32_t furthestAttempt;  // Failed attempt that revealed the most cells
+        int furthestRevealed;  // Cells it revealed
+        uint32_t attempts;  // Attempts it started
+    };
+
+    void search(Worker &worker);  // Plays attempts until one passes, the deadline expires or a lower attempt passed
+    bool repair(Worker &worker, std::vector<int> &layout);  // Moves mines until the solver clears the layout or time runs out
+    bool playOut(Worker &worker, uint32_t attempt, Clock::time_point limit);  // Solves the board from the first click, false when stuck or cancelled
+    bool solveFrom(Worker &worker, int cell, uint32_t attempt, Clock::time_point limit);  // Continues solving from a safe cell
+    int pickCell(const Board &board, const Solver &solver, Rng &rng, const Solver::Constraint &stuck,
+                 bool mine) const;  // Hidden cell to move a mine to or from
+    int wallMine(const Board &board, const Solver &solver) const;  // Deduced mine walling in cells no number reaches
+    void layoutOf(Board &board, uint32_t attempt, std::vector<int> &layout) const;  // Mine cells of a candidate
+    uint64_t attemptSeed(uint32_t attempt) const;
+
+    WorkerPool<Worker> workers;  // One per search thread
+    int rowCount, columnCount, mineCount;  // Size of the requested board
+    int firstRow, firstCol;  // First click of the player
+    uint64_t baseSeed;  // Seed the attempts are derived from
+    Clock::time_point searchDeadline;  // End of the parallel search
+    Clock::time_point deadline;  // End of the whole budget
+    std::atomic<uint32_t> nextAttempt;  // Next attempt number to hand out
+    std::atomic<uint32_t> bestAttempt;  // Lowest attempt that passed so far, attempts above it are cancelled
+};
+
+#endif // GENERATOR_H
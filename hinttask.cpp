@@ -0,0 +1,15 @@
+#include "hinttask.h"
+
+#include "perf.h"
+
+void HintTask::run(double budgetMs) {
+    PERF_SCOPE("hint");
+    cell = solver.findSafeCell(board);
+    guessed = cell < 0;
+    risk = 0.0;
+    if (guessed) {  // No provably safe cell, suggest the one least likely to be a mine instead
+        ProbabilitySolver::Result guess = probabilities.solve(board, solver, budgetMs);
+        cell = guess.bestCell;
+        risk = guess.bestProbability;
+    }
+}
@@ -0,0 +1,26 @@
+#ifndef HINTTASK_H
+#define HINTTASK_H
+
+#include <cstdint>
+#include "board.h"
+#include "probability.h"
+#include "solver.h"
+
+// One hint computation on a private copy of the game, so it can run on a worker thread while the player keeps playing
+// The GUI thread only touches a task while no worker is running it; copying into the same task every time
+// reuses its buffers, and the probability cache survives between hints of the same game
+struct HintTask {
+    Board board;  // Snapshot of the game when the hint was requested
+    Solver solver;  // Snapshot of the solver, updated with the deductions the hint made
+    ProbabilitySolver probabilities;  // Owned by the task, its heat map is only valid while no task is running
+    uint64_t game;  // Game the probability cache belongs to
+    uint64_t version;  // Board version the snapshot was taken at
+    int cell;  // Suggested cell, -1 if there is none
+    bool guessed;  // Whether the cell is only the least likely mine rather than provably safe
+    double risk;  // Mine probability of a guessed cell
+
+    HintTask() : game(0), version(0), cell(-1), guessed(false), risk(0.0) {}
+    void run(double budgetMs);  // Finds a safe cell, or the least risky one when none is provably safe
+};
+
+#endif // HINTTASK_H
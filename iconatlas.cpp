@@ -0,0 +1,15 @@
+#include "iconatlas.h"
+
+// Loads every tile from the resource file and scales it to the cell size
+// Only needs to run again when the cell size changes
+void IconAtlas::load(const QSize &tileSize) {
+    static const char *const names[TileCount] = {
+        "0", "1", "2", "3", "4", "5", "6", "7", "8", "empty", "flag", "hint", "mine"
+    };
+
+    size = tileSize;
+    for (int tile = 0; tile < TileCount; ++tile) {
+        QPixmap img(QString(":/assets/%1.png").arg(names[tile]));
+        pixmaps[tile] = img.scaled(size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    }
+}
@@ -0,0 +1,30 @@
+#ifndef ICONATLAS_H
+#define ICONATLAS_H
+
+#include <QPixmap>
+#include <QSize>
+
+// Decodes every cell image in resources.qrc once and keeps it scaled to the current cell size
+// Cell updates share the cached images instead of loading and rescaling a PNG each time
+class IconAtlas {
+public:
+    enum Tile {
+        // Tiles 0-8 show the number of adjacent mines
+        Empty = 9,  // Hidden cell
+        Flag,  // Flagged cell
+        Hint,  // Cell suggested by the hint button
+        Mine,  // Mine shown at the end of the game
+        TileCount
+    };
+
+    void load(const QSize &size);  // Decodes and scales every tile for the given cell size
+
+    const QPixmap &pixmap(int tile) const { return pixmaps[tile]; }
+    QSize tileSize() const { return size; }
+
+private:
+    QPixmap pixmaps[TileCount];  // Scaled image of each tile
+    QSize size;  // Size every tile is scaled to
+};
+
+#endif // ICONATLAS_H
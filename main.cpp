@@ -1,9 +1,60 @@
 #include <QApplication> // Includes the QApplication class which manages application-wide resources
+#include <QCommandLineParser> // Parses the board size options
+#include <cstdio>
 #include "mainwindow.h" // Includes the MainWindow class header to use it in the application
 
+// Reads a board dimension option, reporting values outside [minimum, maximum]
+static bool readSize(const QCommandLineParser &parser, const QCommandLineOption &option, int minimum, int maximum, int &value) {
+    if (!parser.isSet(option)) {
+        return true;
+    }
+    bool ok = false;
+    int parsed = parser.value(option).toInt(&ok);
+    if (!ok || parsed < minimum || parsed > maximum) {
+        std::fprintf(stderr, "--%s must be between %d and %d\n", qPrintable(option.names().first()), minimum, maximum);
+        return false;
+    }
+    value = parsed;
+    return true;
+}
+
 int main(int argc, char *argv[]) { // Main function, entry point of the application
     QApplication app(argc, argv); // Creates an application object with command line arguments
-    MainWindow window; // Creates an instance of MainWindow
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Minesweeper");
+    parser.addHelpOption();
+    QCommandLineOption presetOption("preset", "Board size: beginner, intermediate, expert or huge.", "name");
+    QCommandLineOption rowsOption("rows", "Number of rows, overrides the preset.", "n");
+    QCommandLineOption columnsOption("columns", "Number of columns, overrides the preset.", "n");
+    QCommandLineOption minesOption("mines", "Number of mines, overrides the preset.", "n");
+    parser.addOptions({ presetOption, rowsOption, columnsOption, minesOption });
+    parser.process(app);
+
+    int rows = 10, columns = 10, mines = 10;
+    if (parser.isSet(presetOption)) {
+        QString name = parser.value(presetOption);
+        int found = -1;
+        for (int i = 0; i < MainWindow::presetCount; ++i) {
+            if (name == MainWindow::presets[i].name) {
+                found = i;
+            }
+        }
+        if (found < 0) {
+            std::fprintf(stderr, "Unknown preset %s\n", qPrintable(name));
+            return 1;
+        }
+        rows = MainWindow::presets[found].rows;
+        columns = MainWindow::presets[found].columns;
+        mines = MainWindow::presets[found].mines;
+    }
+    if (!readSize(parser, rowsOption, 1, MainWindow::maxSide, rows) ||
+        !readSize(parser, columnsOption, 1, MainWindow::maxSide, columns) ||
+        !readSize(parser, minesOption, 0, MainWindow::maxSide * MainWindow::maxSide - 1, mines)) {
+        return 1;
+    }
+
+    MainWindow window(rows, columns, mines); // Creates an instance of MainWindow
     window.show(); // Shows the MainWindow instance
     return app.exec(); // Enters the main event loop and waits until exit() is called, returns the application's exit code
 }
@@ -1,12 +1,66 @@
 #include "mainwindow.h"
 
-MainWindow::MainWindow(QWidget *parent)
-    : QMainWindow(parent), score(0) { // Initialize score to 0
-    rows = 10;  // Example size, could be configurable
-    columns = 10;
-    numMines = 10;
+#include <algorithm>
+#include <climits>
+#include <QDialog>
+#include <QDialogButtonBox>
+#include <QFile>
+#include <QFileDialog>
+#include <QFormLayout>
+#include <QInputDialog>
+#include <QMenuBar>
+#include <QRandomGenerator>
+#include <QShortcut>
+#include <QSpinBox>
+#include <QStatusBar>
+#include <QTimer>
+#include <QtConcurrent>
+
+static const double noGuessBudgetMs = 50.0;  // Longest the first click may wait for a no-guess layout
+static const double hintBudgetMs = 200.0;  // Time the probability solver may take, it runs in the background
+
+const MainWindow::Preset MainWindow::presets[] = {
+    { "beginner", "&Beginner (9x9, 10 mines)", 9, 9, 10 },
+    { "intermediate", "&Intermediate (16x16, 40 mines)", 16, 16, 40 },
+    { "expert", "&Expert (16x30, 99 mines)", 16, 30, 99 },
+    { "huge", "&Huge (2000x2000, 825000 mines)", 2000, 2000, 825000 }  // Expert density
+};
+const int MainWindow::presetCount = sizeof(presets) / sizeof(presets[0]);
+
+MainWindow::MainWindow(int startRows, int startColumns, int startMines, QWidget *parent)
+    : QMainWindow(parent) {
+    rows = startRows;
+    columns = startColumns;
+    numMines = std::min(startMines, rows * columns - 1);
     w = 25;
     h = 24;
+    gameNumber = 0;
+    boardVersion = 0;
+    hintTask = std::make_shared<HintTask>();
+    connect(&hintWatcher, &QFutureWatcher<void>::finished, this, &MainWindow::hintReady);
+    icons.load(QSize(w, h));  // Decode and scale every cell image once
+
+    QMenu *fileMenu = menuBar()->addMenu("&File");
+    saveAction = fileMenu->addAction("&Save game...", this, &MainWindow::saveGame, QKeySequence::Save);
+    fileMenu->addAction("&Load game...", this, &MainWindow::loadGame, QKeySequence::Open);
+    fileMenu->addAction("Open &puzzle...", this, &MainWindow::openPuzzle);
+    fileMenu->addAction("Save &replay...", this, &MainWindow::saveReplay);
+    QMenu *editMenu = menuBar()->addMenu("&Edit");
+    editMenu->addAction("&Undo", this, &MainWindow::undoMove, QKeySequence::Undo);
+    QMenu *gameMenu = menuBar()->addMenu("&Game");
+    for (int i = 0; i < presetCount; ++i) {
+        const Preset &preset = presets[i];
+        gameMenu->addAction(preset.label, this, [this, &preset]() { setBoardSize(preset.rows, preset.columns, preset.mines); });
+    }
+    gameMenu->addAction("&Custom...", this, &MainWindow::customSize);
+#ifdef MINESWEEPER_PERF
+    fileMenu->addAction("Export &trace...", this, [this]() {
+        QString path = QFileDialog::getSaveFileName(this, "Export trace", "trace.json", "Chrome traces (*.json)");
+        if (!path.isEmpty() && !Perf::writeTrace(QFile::encodeName(path).toStdString())) {
+            QMessageBox::warning(this, "Export trace", "Could not write " + path);
+        }
+    });
+#endif
 
     QWidget *centralWidget = new QWidget(this);  // Create a central widget for the main window
     setCentralWidget(centralWidget);  // Set this widget as the central widget of the window
@@ -26,11 +80,31 @@ MainWindow::MainWindow(QWidget *parent)
     topLayout->addWidget(hintButton);  // Add the hint button to the top layout
     connect(hintButton, &QPushButton::clicked, this, &MainWindow::provideHint);  // Connect the hint button's clicked signal to the provideHint slot
 
-    gridLayout = new QGridLayout(centralWidget);  // Create a grid layout manager for the cell buttons
-    mainLayout->addLayout(gridLayout);  // Add the grid layout below the score label
+    noGuessBox = new QCheckBox("No guessing", this);  // Competitive mode, every board can be cleared by logic alone
+    topLayout->addWidget(noGuessBox);
+
+    endlessBox = new QCheckBox("Endless", this);  // Unbounded field at the density of the current grid
+    topLayout->addWidget(endlessBox);
+    connect(endlessBox, &QCheckBox::toggled, this, &MainWindow::restartGame);
+
+    scrollArea = new QScrollArea(this);  // Scrolls the grid when it does not fit in the window
+    scrollArea->setFrameShape(QFrame::NoFrame);
+    scrollArea->setAlignment(Qt::AlignCenter);
+    mainLayout->addWidget(scrollArea);  // Add the grid below the score label
+
+    endlessView = new EndlessView(&endless, &icons, this);
+    endlessView->hide();
+    mainLayout->addWidget(endlessView);
+    connect(endlessView, &EndlessView::cellClicked, this, &MainWindow::revealEndlessCell);
+    connect(endlessView, &EndlessView::cellMarked, this, &MainWindow::markEndlessCell);
 
     initializeGame();
 
+#ifdef MINESWEEPER_PERF
+    perfOverlay = new PerfOverlay(centralWidget);
+    QShortcut *overlayShortcut = new QShortcut(QKeySequence(Qt::Key_F3), this);
+    connect(overlayShortcut, &QShortcut::activated, perfOverlay, &PerfOverlay::toggle);
+#endif
 }
 
 
@@ -38,236 +112,360 @@ MainWindow::MainWindow(QWidget *parent)
 void MainWindow::initializeGame() {
     setupGame();  // Sets up the initial game configuration and places mines
 
-    const QSize buttonSize(30, 30); // Standard size for all grid buttons
-
-    // Create buttons and configure their properties
-    for (int i = 0; i < rows; ++i) {
-        for (int j = 0; j < columns; ++j) {
-            QPushButton *button = new QPushButton("", this);
-            button->setFixedSize(buttonSize);
-            QPixmap img(":/assets/empty.png");
-            button->setIcon(QIcon(img.scaled(QSize(w, h), Qt::IgnoreAspectRatio, Qt::SmoothTransformation)));
-            button->setIconSize(QSize(w, h));
-            gridLayout->addWidget(button, i, j);
-            buttonGrid[i][j] = button;
-            connect(button, &QPushButton::clicked, this, &MainWindow::cellClicked);
-            button->setProperty("row", i);
-            button->setProperty("column", j);
-        }
-    }
-    gridLayout->setSpacing(0);  // Ensures buttons are tightly packed with no gaps
-    gridLayout->setContentsMargins(0, 0, 0, 0);  // Removes extra margins around the grid
+    boardView = new BoardView(&board, &icons);  // A single widget paints every cell
+    scrollArea->setWidget(boardView);
+    connect(boardView, &BoardView::cellClicked, this, &MainWindow::revealCell);  // Left click reveals a cell
+    connect(boardView, &BoardView::cellMarked, this, &MainWindow::markCell);  // Right click toggles a flag
 }
 
 
 
-// Sets up the game by initializing the grid, placing mines randomly, and calculating mine adjacency counts.
+// Sets up a new game on the engine and resets the hint state
 void MainWindow::setupGame() {
-    QRandomGenerator *gen = QRandomGenerator::global();  // Access global random number generator
-    flags.resize(rows, QVector<bool>(columns, false));  // Reset the flag status for all cells
-    mineGrid.resize(rows, QVector<int>(columns, 0));  // Initialize mine grid with zeros
-    buttonGrid.resize(rows, QVector<QPushButton*>(columns));  // Prepare the button grid
+    // Clears the grid, the mines are placed around the first revealed cell
+    board.setupGame(rows, columns, numMines, QRandomGenerator::global()->generate64());
+    moveLog.restart(board);  // The first game starts the log
+    if (endlessBox->isChecked()) {
+        endless.setupGame(board.seed(), static_cast<double>(numMines) / (rows * columns));
+    }
+    solver.reset(board);  // Forget the deductions from the previous game
+    solverStale = false;
+    gameNumber++;
+    boardVersion++;  // Drops a hint still being computed for the previous game
 
     hintGiven = false;  // Reset hint status
     hintRow = -1;  // Reset last hinted row index
     hintCol = -1;  // Reset last hinted column index
+}
+
 
-    // Reset all cells to zero before placing mines
-    for (int i = 0; i < rows; ++i) {
-        for (int j = 0; j < columns; ++j) {
-            mineGrid[i][j] = 0;
+// Reveals the content of a cell at the specified row and column
+// Clicking a revealed number chords instead
+void MainWindow::revealCell(int row, int col) {
+    if (board.state() != Board::Playing) {
+        return;  // The game is over, further clicks are ignored
+    }
+    if (board.isRevealed(row, col)) {
+        chordCell(row, col);
+        return;
+    }
+    PERF_ACTION("reveal action");
+    if (!board.minesPlaced() && noGuessBox->isChecked() && board.state() == Board::Playing) {
+        // The layout depends on the first click, so it is generated here rather than on restart
+        NoGuessGenerator::Result layout = generator.generate(board.rows(), board.columns(), board.mineCount(), board.seed(),
+                                                             row, col, noGuessBudgetMs);
+        board.setMines(layout.mines);
+        moveLog.recordLayout(layout.mines);  // Generation depends on timing, so replays need the layout itself
+        if (!layout.solvable) {
+            statusBar()->showMessage("Could not finish a no-guess board in time, this one may need a guess", 5000);
         }
     }
 
-    // Randomly place mines ensuring no duplicates
-    int minesPlaced = 0;
-    while (minesPlaced < numMines) {
-        int r = gen->bounded(rows);
-        int c = gen->bounded(columns);
-        if (mineGrid[r][c] == 0) {  // Check if the cell is already occupied by a mine
-            mineGrid[r][c] = -1;  // Assign mine indicator (-1)
-            minesPlaced++;
-        }
+    Board::State before = board.state();
+    const std::vector<int> &revealedCells = board.revealCell(row, col);  // Every cell revealed by this click
+    moveLog.recordReveal(board.index(row, col), revealedCells, board, before);
+    finishAction(revealedCells, before);
+}
+
+
+// Reveals every unflagged neighbour of a number whose mines are all flagged
+void MainWindow::chordCell(int row, int col) {
+    if (board.state() != Board::Playing) {
+        return;
     }
+    PERF_ACTION("chord action");
+    Board::State before = board.state();
+    const std::vector<int> &revealedCells = board.chordCell(row, col);
+    moveLog.recordChord(board.index(row, col), revealedCells, board, before);
+    finishAction(revealedCells, before);
+}
 
-    // Calculate the number of adjacent mines for each cell
-    for (int i = 0; i < rows; ++i) {
-        for (int j = 0; j < columns; ++j) {
-            if (mineGrid[i][j] == -1) {
-                // Iterate over all adjacent cells
-                for (int dx = -1; dx <= 1; dx++) {
-                    for (int dy = -1; dy <= 1; dy++) {
-                        int ni = i + dx;
-                        int nj = j + dy;
-                        if (ni >= 0 && ni < rows && nj >= 0 && nj < columns && mineGrid[ni][nj] != -1) {
-                            mineGrid[ni][nj]++;  // Increment adjacent mine count
-                        }
-                    }
-                }
-            }
-        }
+
+// Completes one action as a single transaction, however many cells it revealed:
+// Triggers game over if a mine was revealed,
+// Otherwise updates the solver, repaints the batch and the score, and checks for the win once
+void MainWindow::finishAction(const std::vector<int> &revealedCells, Board::State before) {
+    if (revealedCells.empty() && board.state() == before) {
+        return;  // Nothing changed, whether or not the game is still going
+    }
+    boardVersion++;
+    if (board.state() == Board::Lost) {
+        gameOver();
+        return;
+    }
+
+    if (solverStale) {
+        solver.rebuild(board);  // Deductions made before an undo may rest on cells that are hidden again
+        solverStale = false;
+    } else {
+        solver.update(board, revealedCells);  // Only the cells around this batch need to be re-examined
+    }
+    boardView->setHeatMap(nullptr);  // Probabilities are stale once anything is revealed
+    boardView->updateCells(revealedCells);
+    updateScore();  // Update score once for the whole batch
+
+    if (board.state() == Board::Won) {
+        gameWon();
     }
 }
 
 
-// Responds to a cell being clicked by identifying the button and initiating the reveal process
-void MainWindow::cellClicked() {
-    QPushButton *button = qobject_cast<QPushButton *>(sender());
-    int row = button->property("row").toInt();
-    int column = button->property("column").toInt();
-    revealCell(row, column);
+// Toggles a flag on a cell when right-clicked, used to mark suspected mines
+void MainWindow::markCell(int row, int col) {
+    PERF_ACTION("flag action");
+    if (board.markCell(row, col)) {  // Check if the cell can be interacted with
+        moveLog.recordFlag(board.index(row, col));
+        boardView->updateCell(row, col);
+    }
 }
 
 
-// Reveals the content of a cell at the specified row and column
-// Triggers game over if a mine is revealed,
-// Otherwise updates the cell's display and potentially reveals adjacent cells
-void MainWindow::revealCell(int row, int col) {
-    if (mineGrid[row][col] == -1) {
+// Reveals a cell of the endless field, or chords on a revealed number
+// A cascade too large for one event continues from the event loop
+void MainWindow::revealEndlessCell(int x, int y) {
+    if (endless.state() != Board::Playing) {
+        return;  // The game is over, further clicks are ignored
+    }
+    PERF_ACTION("endless reveal action");
+    if (endless.isRevealed(x, y)) {
+        endless.chordCell(x, y);
+    } else {
+        endless.revealCell(x, y);
+    }
+    if (endless.state() == Board::Lost) {
         gameOver();
+        return;
     }
-    else {
-        updateCellDisplay(row, col);
-        if (mineGrid[row][col] == 0) {
-            revealAdjacentCells(row, col);
-            QPixmap img(":/assets/0.png");
-            buttonGrid[row][col]->setIcon(QIcon(img.scaled(QSize(w, h), Qt::IgnoreAspectRatio, Qt::SmoothTransformation)));
-            buttonGrid[row][col]->setIconSize(QSize(w, h));
-            buttonGrid[row][col]->setEnabled(false);
-        }
+
+    endlessView->update();  // The view only covers the viewport, repainting all of it is cheap
+    updateScore();
+    if (endless.revealPending()) {
+        QTimer::singleShot(0, this, &MainWindow::continueEndlessReveal);
     }
 }
 
 
-// Updates the display of a cell based on its mine proximity count and disables the cell
-// Updates the score and checks if the game is won
-void MainWindow::updateCellDisplay(int row, int col) {
-    QPushButton *button = buttonGrid[row][col];
-    button->setEnabled(false);  // Disable the button to prevent further clicks
-    updateScore();  // Update score when a cell is revealed
-
-    // Load and set the appropriate image based on the number of adjacent mines
-    QPixmap img(":/assets/" + QString::number(mineGrid[row][col]) + ".png");
-    button->setIcon(QIcon(img.scaled(QSize(w, h), Qt::IgnoreAspectRatio, Qt::SmoothTransformation)));
-    button->setIconSize(QSize(w, h));  // Ensure the icon fits the button size
-
-    // Check if all non-mine cells have been revealed and end the game if so
-    if (score == rows * columns - numMines) {
-        // Disable all buttons and reveal all mines if the game is won
-        for (int i = 0; i < rows; ++i) {
-            for (int j = 0; j < columns; ++j) {
-                buttonGrid[i][j]->setEnabled(false);
-                if (mineGrid[i][j] == -1) {
-                    QPixmap img(":/assets/mine.png");
-                    buttonGrid[i][j]->setIcon(QIcon(img.scaled(QSize(w, h), Qt::IgnoreAspectRatio, Qt::SmoothTransformation)));
-                    buttonGrid[i][j]->setIconSize(QSize(w, h));
-                }
-            }
-        }
-        QMessageBox::information(this, "Game Over", "You Win"); // Notify the player of their victory
+void MainWindow::continueEndlessReveal() {
+    if (!endless.revealPending()) {
+        return;  // The game was restarted in the meantime
+    }
+    endless.continueReveal();
+    endlessView->update();
+    updateScore();
+    if (endless.revealPending()) {
+        QTimer::singleShot(0, this, &MainWindow::continueEndlessReveal);
     }
 }
 
 
-void MainWindow::revealAdjacentCells(int row, int col) {
-    // Directions arrays for moving to adjacent cells (8 directions)
-    static const int dRow[] = {-1, -1, -1, 0, 1, 1, 1, 0};
-    static const int dCol[] = {-1, 0, 1, 1, 1, 0, -1, -1};
+void MainWindow::markEndlessCell(int x, int y) {
+    if (endless.markCell(x, y)) {
+        endlessView->update();
+    }
+}
 
-    // Iterate over all directions
-    for (int i = 0; i < 8; i++) {
-        int newRow = row + dRow[i];
-        int newCol = col + dCol[i];
 
-        // Check bounds and whether the cell has already been revealed
-        if (newRow >= 0 && newRow < rows && newCol >= 0 && newCol < columns && buttonGrid[newRow][newCol]->isEnabled()) {
-            // Only reveal the cell if it has not been revealed yet
-            updateCellDisplay(newRow, newCol);
-            // Recurse if the cell has no adjacent mines
-            if (mineGrid[newRow][newCol] == 0) {
-                revealAdjacentCells(newRow, newCol);
-            }
-        }
+// Displays the current score, the number of safe cells revealed so far
+void MainWindow::updateScore() {
+    if (endlessBox->isChecked()) {
+        scoreLabel->setText(QString("Score: %1").arg(static_cast<qulonglong>(endless.revealedCount())));
+    } else {
+        scoreLabel->setText(QString("Score: %1").arg(board.revealedCount()));
     }
 }
 
 
-// Handles mouse press events to detect right-clicks and toggle flags on cells
-void MainWindow::mousePressEvent(QMouseEvent *event) {
-    if (event->button() == Qt::RightButton) { // Check if the right mouse button was pressed
-        QWidget *clickedWidget = childAt(event->pos()); // Identify the widget at the clicked position
-        if (clickedWidget) {
-            for (int i = 0; i < rows; ++i) {
-                for (int j = 0; j < columns; ++j) {
-                    if (clickedWidget == buttonGrid[i][j]) {
-                        markCell(i, j);  // Call markCell to toggle the flag
-                        return;
-                    }
-                }
-            }
-        }
+// Handles the winning scenario, the view reveals all mines once the game is over
+void MainWindow::gameWon() {
+    boardView->update();
+    QMessageBox::information(this, "Game Over", "You Win"); // Notify the player of their victory
+}
+
+
+// Handles the game over scenario, the view reveals all mines and ignores further clicks
+void MainWindow::gameOver() {
+    boardView->update();
+    endlessView->update();
+    QMessageBox::information(this, "Game Over", "You Lose");  // Show a message box indicating the player has lost the game
+}
+
+
+void MainWindow::saveGame() {
+    QString path = QFileDialog::getSaveFileName(this, "Save game", QString(), "Saved games (*.msav)");
+    if (path.isEmpty()) {
+        return;
+    }
+    if (!GameFile::save(board, QFile::encodeName(path).toStdString())) {
+        QMessageBox::warning(this, "Save game", "Could not write " + path);
     }
 }
 
 
-// Toggles a flag on a cell when right-clicked, used to mark suspected mines
-void MainWindow::markCell(int row, int col) {
-    if (buttonGrid[row][col]->isEnabled()) {  // Check if the cell can be interacted with
-        if (flags[row][col]) {  // If the cell is already flagged
-            QPixmap img(":/assets/empty.png");  // Load the empty icon
-            buttonGrid[row][col]->setIcon(QIcon(img.scaled(QSize(w, h), Qt::IgnoreAspectRatio, Qt::SmoothTransformation)));
-            buttonGrid[row][col]->setIconSize(QSize(w, h));
-            flags[row][col] = false;  // Update flag status to not flagged
-        } else {  // If the cell is not flagged
-            QPixmap img(":/assets/flag.png");  // Load the flag icon
-            buttonGrid[row][col]->setIcon(QIcon(img.scaled(QSize(w, h), Qt::IgnoreAspectRatio, Qt::SmoothTransformation)));
-            buttonGrid[row][col]->setIconSize(QSize(w, h));
-            flags[row][col] = true;  // Update flag status to flagged
-        }
+void MainWindow::loadGame() {
+    QString path = QFileDialog::getOpenFileName(this, "Load game", QString(), "Saved games (*.msav)");
+    if (path.isEmpty()) {
+        return;
     }
+    if (!GameFile::load(board, QFile::encodeName(path).toStdString())) {
+        QMessageBox::warning(this, "Load game", path + " is not a saved game");
+        return;
+    }
+    boardLoaded();
 }
 
 
-// Increments and displays the current score each time a cell is revealed
-void MainWindow::updateScore() {
-    score++;
-    scoreLabel->setText(QString("Score: %1").arg(score));
+// Asks for an archive and a puzzle number, then makes the first click the puzzle was generated around
+void MainWindow::openPuzzle() {
+    QString path = QFileDialog::getOpenFileName(this, "Open puzzle", QString(), "Puzzle archives (*.mpzl)");
+    if (path.isEmpty()) {
+        return;
+    }
+    if (!archive.open(QFile::encodeName(path).toStdString()) || archive.count() == 0) {
+        QMessageBox::warning(this, "Open puzzle", path + " is not a puzzle archive");
+        return;
+    }
+    bool ok = false;
+    int number = QInputDialog::getInt(this, "Open puzzle", "Puzzle number", 1, 1,
+                                      static_cast<int>(std::min<uint64_t>(archive.count(), INT_MAX)), 1, &ok);
+    if (!ok) {
+        return;
+    }
+
+    if (!archive.load(board, number - 1)) {
+        QMessageBox::warning(this, "Open puzzle", QString("Puzzle %1 of %2 is damaged").arg(number).arg(path));
+        return;
+    }
+    boardLoaded();
+    int first = archive.puzzle(number - 1).firstCell;
+    revealCell(board.rowOf(first), board.columnOf(first));
 }
 
 
+void MainWindow::saveReplay() {
+    QString path = QFileDialog::getSaveFileName(this, "Save replay", QString(), "Replays (*.mrep)");
+    if (path.isEmpty()) {
+        return;
+    }
+    if (!moveLog.save(QFile::encodeName(path).toStdString())) {
+        QMessageBox::warning(this, "Save replay", "Could not write " + path);
+    }
+}
 
-// Handles the game over scenario by disabling all cells and revealing all mines
-void MainWindow::gameOver() {
-    for (int i = 0; i < rows; ++i) {
-        for (int j = 0; j < columns; ++j) {
-            buttonGrid[i][j]->setEnabled(false);  // Disable all buttons to prevent further interaction
-            if (mineGrid[i][j] == -1) {  // Check if the cell contains a mine
-                QPixmap img(":/assets/mine.png");  // Load the mine image
-                buttonGrid[i][j]->setIcon(QIcon(img.scaled(QSize(w, h), Qt::IgnoreAspectRatio, Qt::SmoothTransformation)));
-                buttonGrid[i][j]->setIconSize(QSize(w, h));
-            }
-        }
+
+// Reverts only the cells of the last move; the solver is rebuilt lazily, so undo stays as cheap as the move
+void MainWindow::undoMove() {
+    if (endlessBox->isChecked()) {
+        return;
     }
-    QMessageBox::information(this, "Game Over", "You Lose");  // Show a message box indicating the player has lost the game
+    PERF_ACTION("undo action");
+    bool ended = board.state() != Board::Playing;
+    if (!moveLog.undo(board, undoneCells)) {
+        return;
+    }
+    boardVersion++;  // Drops a hint being computed for the position before the undo
+    solverStale = true;
+    boardView->setHeatMap(nullptr);
+    if (ended) {
+        boardView->update();  // The mines shown at the end of the game are hidden again
+    } else {
+        boardView->updateCells(undoneCells);
+    }
+    updateScore();
 }
 
 
-// Resets the game to the initial state, re-enabling all buttons and clearing the minefield
+// A loaded board may differ in size and progress, so everything derived from the old one is rebuilt
+void MainWindow::boardLoaded() {
+    if (endlessBox->isChecked()) {
+        QSignalBlocker blocker(endlessBox);  // Unticking would restart and replace the loaded board
+        endlessBox->setChecked(false);
+        scrollArea->show();
+        endlessView->hide();
+        hintButton->setEnabled(!hintWatcher.isRunning());
+        noGuessBox->setEnabled(true);
+        saveAction->setEnabled(true);
+    }
+    rows = board.rows();
+    columns = board.columns();
+    numMines = board.mineCount();
+    solver.rebuild(board);
+    solverStale = false;
+    moveLog.start(board);  // A saved game replays from the position it was loaded in, not from its first click
+    if (board.minesPlaced()) {
+        std::vector<int> mines;
+        board.mineBits().forEach([&](int row, int col) { mines.push_back(board.index(row, col)); });
+        moveLog.recordLayout(mines);
+    }
+    if (board.revealedCount() > 0 || board.flaggedBits().count() > 0 || board.state() != Board::Playing) {
+        moveLog.recordRestore(board);  // That position is part of the log, a fresh puzzle starts from its first click
+    }
+    gameNumber++;
+    boardVersion++;  // Drops a hint still being computed for the previous board
+    hintGiven = false;
+    hintRow = -1;
+    hintCol = -1;
+
+    boardView->setHintCell(-1, -1);
+    boardView->setHeatMap(nullptr);
+    boardView->boardResized();
+    boardView->update();
+    updateScore();
+}
+
+
+// Resets the game to the initial state, clearing the minefield
 void MainWindow::restartGame() {
-    bombCoordinates.clear();  // Clear any stored bomb coordinates
     setupGame();  // Re-initialize the game setup, including placing new mines
-    updateScore();  // Reset and update the score display
-
-    for (int i = 0; i < rows; ++i) {
-        for (int j = 0; j < columns; ++j) {
-            buttonGrid[i][j]->setEnabled(true);  // Enable all buttons for new interactions
-            QPixmap img(":/assets/empty.png");  // Load the empty icon
-            buttonGrid[i][j]->setIcon(QIcon(img.scaled(QSize(w, h), Qt::IgnoreAspectRatio, Qt::SmoothTransformation)));
-            buttonGrid[i][j]->setIconSize(QSize(w, h));
-        }
+    bool isEndless = endlessBox->isChecked();
+    scrollArea->setVisible(!isEndless);
+    endlessView->setVisible(isEndless);
+    hintButton->setEnabled(!isEndless && !hintWatcher.isRunning());  // The solvers need a finite grid
+    noGuessBox->setEnabled(!isEndless);
+    saveAction->setEnabled(!isEndless);  // Only the grid has a file format
+    if (isEndless) {
+        endlessView->centerOn(0, 0);
+        endlessView->setFocus();
+    }
+    boardView->setHintCell(-1, -1);
+    boardView->setHeatMap(nullptr);
+    boardView->boardResized();  // Every cell is hidden again, and the size may have changed
+    updateScore();  // Update the score display
+}
+
+
+// The engine, solver and view keep their buffers, so switching size costs no more than a restart
+void MainWindow::setBoardSize(int newRows, int newColumns, int mines) {
+    rows = newRows;
+    columns = newColumns;
+    numMines = std::min(mines, rows * columns - 1);  // The first click always needs a free cell
+    restartGame();
+}
+
+
+void MainWindow::customSize() {
+    QDialog dialog(this);
+    dialog.setWindowTitle("Custom size");
+    QFormLayout *form = new QFormLayout(&dialog);
+    QSpinBox *rowBox = new QSpinBox(&dialog);
+    rowBox->setRange(1, maxSide);
+    rowBox->setValue(rows);
+    form->addRow("Rows", rowBox);
+    QSpinBox *columnBox = new QSpinBox(&dialog);
+    columnBox->setRange(1, maxSide);
+    columnBox->setValue(columns);
+    form->addRow("Columns", columnBox);
+    QSpinBox *mineBox = new QSpinBox(&dialog);
+    mineBox->setRange(0, maxSide * maxSide - 1);
+    mineBox->setValue(numMines);
+    form->addRow("Mines", mineBox);
+    QDialogButtonBox *buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, &dialog);
+    connect(buttons, &QDialogButtonBox::accepted, &dialog, &QDialog::accept);
+    connect(buttons, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+    form->addRow(buttons);
+
+    if (dialog.exec() == QDialog::Accepted) {
+        setBoardSize(rowBox->value(), columnBox->value(), mineBox->value());
     }
-    score = 0;  // Reset the score
-    scoreLabel->setText("Score: 0");  // Update the score display
 }
 
 
@@ -275,141 +473,82 @@ void MainWindow::restartGame() {
  // Provides a hint to the player by marking a potentially safe cell
  // If a hint is already given and not yet acted upon, it either resets the hint or reveals the cell depending on the cell's state and player actions
 void MainWindow::provideHint() {
+    if (board.state() != Board::Playing) {
+        return;
+    }
     if (hintGiven) { // Check if a hint has already been provided
-        if (!buttonGrid[hintRow][hintCol]->isEnabled()) { // If the hinted cell is disabled, reset hint
+        if (board.isRevealed(hintRow, hintCol)) { // If the hinted cell is revealed, reset hint
             hintGiven = false;
             provideHint();
 
         }
         else {
-            if (flags[hintRow][hintCol]) { // If the hinted cell is flagged, toggle the hint appearance
-                QPixmap img(":/assets/hint.png");
-                buttonGrid[hintRow][hintCol]->setIcon(QIcon(img.scaled(QSize(w, h), Qt::IgnoreAspectRatio, Qt::SmoothTransformation)));
-                buttonGrid[hintRow][hintCol]->setIconSize(QSize(w, h));
-                flags[hintRow][hintCol] = false;
+            if (board.isFlagged(hintRow, hintCol)) { // If the hinted cell is flagged, toggle the hint appearance
+                board.setFlag(hintRow, hintCol, false);
+                moveLog.recordFlag(board.index(hintRow, hintCol));
+                boardView->updateCell(hintRow, hintCol);
                 hintGiven = true;
             }
             else {
-                revealCell(hintRow, hintCol); // Reveal the cell if no flags and the cell is enabled
+                boardView->setHintCell(-1, -1);
+                revealCell(hintRow, hintCol); // Reveal the cell if no flags and the cell is still hidden
                 hintGiven = false;
             }
         }
     }
     else {
-        findSafeCell(); // Find a new safe cell to hint at if no hint is currently active
-        if (hintRow > -1) { // If a safe cell is found, mark it visually
-            QPixmap img(":/assets/hint.png");
-            buttonGrid[hintRow][hintCol]->setIcon(QIcon(img.scaled(QSize(w, h), Qt::IgnoreAspectRatio, Qt::SmoothTransformation)));
-            buttonGrid[hintRow][hintCol]->setIconSize(QSize(w, h)); // Use a distinct icon or color to mark the hint
-            hintGiven = true;
+        // Find a new safe cell to hint at if no hint is currently active
+        // The search runs on a worker thread against a copy of the game, so the board stays responsive meanwhile
+        if (hintWatcher.isRunning()) {
+            return;  // The previous hint is still being computed
+        }
+        if (solverStale) {
+            solver.rebuild(board);
+            solverStale = false;
+        }
+        hintTask->board.snapshot(board);
+        hintTask->solver.snapshot(solver);
+        if (hintTask->game != gameNumber) {
+            hintTask->probabilities.reset();  // Cached components belong to the previous game
+            hintTask->game = gameNumber;
         }
+        hintTask->version = boardVersion;
+
+        boardView->setHeatMap(nullptr);  // The worker is about to overwrite the probabilities
+        hintButton->setEnabled(false);
+        hintButton->setText("Thinking...");
+        std::shared_ptr<HintTask> task = hintTask;
+        hintWatcher.setFuture(QtConcurrent::run([task]() { task->run(hintBudgetMs); }));
         return;
     }
 }
 
 
- // Searches for a safe cell to hint to the player based on current game state
- // The function examines adjacent cells to determine a cell with no adjacent mines, considering the mines identified by the game
-void MainWindow::findSafeCell() {
-    bool change = false;
-    hintRow = -1;
-    hintCol = -1;
-
-    // Logic to analyze the game grid and identify a cell that can be safely revealed as a hint
-    // Iterates through the grid, examining the count of adjacent mines
-    for (int i = 0; i < rows; ++i) {
-        for (int j = 0; j < columns; ++j) {
-            if (!buttonGrid[i][j]->isEnabled()) {
-
-                int neighbourCnt = 0; // Count of neighbouring cells that are still hidden
-
-                // Calculate hidden neighbours around the current cell
-                for (int dRow = -1; dRow <= 1; ++dRow) {
-                    for (int dCol = -1; dCol <= 1; ++dCol) {
-
-                        int adjRow = i + dRow;
-                        int adjCol = j + dCol;
-                        if (adjRow >= 0 && adjRow < rows && adjCol >= 0 && adjCol < columns) { // Check bounds
-                            if (buttonGrid[adjRow][adjCol]->isEnabled()) {
-                                neighbourCnt++;
-                            }
-                        }
-
-                    }
-                }
-
-                // If the number of hidden neighbours is less than or equal to the mine count, mark as bomb
-                if (neighbourCnt <= mineGrid[i][j]) {
-                    for (int dRow = -1; dRow <= 1; ++dRow) {
-                        for (int dCol = -1; dCol <= 1; ++dCol) {
-
-                            int adjRow = i + dRow;
-                            int adjCol = j + dCol;
-                            if (adjRow >= 0 && adjRow < rows && adjCol >= 0 && adjCol < columns) { // Check bounds
-                                if (buttonGrid[adjRow][adjCol]->isEnabled()) {
-                                    QPoint checkPoint(adjRow, adjCol);
-                                    if (!bombCoordinates.contains(checkPoint)) {
-                                        bombCoordinates.append(QPoint(adjRow, adjCol));
-                                        change = true;
-                                    }
-                                }
-                            }
-                        }
-                    }
-                }
-
-                else { // Decrement the count according to bomb array
-                    int neighbourMines = mineGrid[i][j];
-                    for (int dRow = -1; dRow <= 1; ++dRow) {
-                        for (int dCol = -1; dCol <= 1; ++dCol) {
-
-                            int adjRow = i + dRow;
-                            int adjCol = j + dCol;
-                            if (adjRow >= 0 && adjRow < rows && adjCol >= 0 && adjCol < columns) { // Check bounds
-                                if (buttonGrid[adjRow][adjCol]->isEnabled()) {
-                                    QPoint checkPoint(adjRow, adjCol);
-                                    if (bombCoordinates.contains(checkPoint)) { // Returns true if the QPoint is in the vector
-                                        neighbourMines-- ;
-                                    }
-                                }
-                            }
-                        }
-                    }
-                    if (neighbourMines == 0) {
-                        for (int dRow = -1; dRow <= 1; ++dRow) {
-                            for (int dCol = -1; dCol <= 1; ++dCol) {
-                                int adjRow = i + dRow;
-                                int adjCol = j + dCol;
-                                if (adjRow >= 0 && adjRow < rows && adjCol >= 0 && adjCol < columns) { // Check bounds
-                                    if (buttonGrid[adjRow][adjCol]->isEnabled()) {
-                                        QPoint checkPoint(adjRow, adjCol);
-                                        if (!bombCoordinates.contains(checkPoint)) { // Returns true if the QPoint is in the vector
-                                            // Process hint coordinates
-                                            hintRow = adjRow;
-                                            hintCol = adjCol;
-                                            return;
-                                        }
-                                    }
-                                }
-                            }
-                        }
-                    }
-                }
-            }
-
-
-        }
+// Shows the hint computed in the background, unless the board changed while it ran
+void MainWindow::hintReady() {
+    hintButton->setEnabled(!endlessBox->isChecked());
+    hintButton->setText("Hint");
+    if (hintTask->version != boardVersion) {
+        return;  // Computed for a position that no longer exists
     }
 
-    if (change) {
-        findSafeCell(); // Recursively find safe cells if changes have been made
+    std::swap(solver, hintTask->solver);  // Keep the deductions the hint made, the snapshot is up to date
+    if (hintTask->guessed) { // No provably safe cell, the hint is the one least likely to be a mine
+        boardView->setHeatMap(&hintTask->probabilities.probabilities());
+        statusBar()->showMessage(QString("No safe cell, best guess has a %1% mine risk").arg(qRound(hintTask->risk * 100.0)), 5000);
+    }
+    if (hintTask->cell > -1) { // If a safe cell is found, mark it visually
+        hintRow = board.rowOf(hintTask->cell);
+        hintCol = board.columnOf(hintTask->cell);
+        boardView->setHintCell(hintRow, hintCol); // Use a distinct icon to mark the hint
+        moveLog.recordHint(hintTask->cell);
+        hintGiven = !hintTask->guessed;  // Pressing Hint again only reveals a provably safe cell, never a guess
     }
-
-
 }
 
 
 
 
 MainWindow::~MainWindow() {
+    hintWatcher.waitForFinished();  // The worker still uses the board snapshot
 }
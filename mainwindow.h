@@ -2,50 +2,98 @@
 #define MAINWINDOW_H
 
 #include <QMainWindow>
+#include <QAction>
 #include <QPushButton>
-#include <QGridLayout>
-#include <QVector>
+#include <QCheckBox>
+#include <QScrollArea>
+#include <QVBoxLayout>
+#include <QHBoxLayout>
 #include <QLabel>
-#include <QMouseEvent>
 #include <QSize>
 #include <QMessageBox>
-#include <QRandomGenerator>
+#include <QFutureWatcher>
+#include <memory>
+#include "board.h"
+#include "boardview.h"
+#include "endless.h"
+#include "endlessview.h"
+#include "gamefile.h"
+#include "generator.h"
+#include "hinttask.h"
+#include "iconatlas.h"
+#include "movelog.h"
+#include "perf.h"
+#include "solver.h"
+#ifdef MINESWEEPER_PERF
+#include "perfoverlay.h"
+#endif
 
 class MainWindow : public QMainWindow {  // Defines the main window class that inherits from QMainWindow
     Q_OBJECT
 
 public:
-    MainWindow(QWidget *parent = nullptr);  // Constructor declaration, defaults to nullptr if not provided
-    ~MainWindow();  // Destructor declaration
+    struct Preset {
+        const char *name;  // Name on the command line
+        const char *label;  // Name in the Game menu
+        int rows, columns, mines;
+    };
+    static const Preset presets[];  // Standard board sizes, from the smallest to the largest
+    static const int presetCount;
+    static const int maxSide = 4000;  // Largest number of rows or columns a board may have
 
-protected:
-    void mousePressEvent(QMouseEvent *event) override;  // Overriding the mousePressEvent to handle right-click events specifically
+    MainWindow(int startRows = 10, int startColumns = 10, int startMines = 10, QWidget *parent = nullptr);  // Starts a game of the given size
+    ~MainWindow();  // Destructor declaration
 
 private slots:
-    void cellClicked();  // Slot to handle when a cell is clicked
+    void revealCell(int row, int col);  // Reveals a cell at the given row and column
+    void markCell(int row, int col);  // Toggles the flag on a cell
+    void chordCell(int row, int col);  // Reveals the neighbours of a number whose mines are all flagged
     void restartGame();  // Slot for handling restart
     void provideHint();  // Slot to handle the hint logic
+    void hintReady();  // Shows the result of the hint computed in the background
+    void revealEndlessCell(int x, int y);  // Reveals a cell of the endless field
+    void markEndlessCell(int x, int y);  // Toggles the flag on a cell of the endless field
+    void continueEndlessReveal();  // Reveals the next part of a cascade too large for one event
+    void saveGame();  // Writes the current game to a file chosen by the player
+    void loadGame();  // Replaces the current game with a saved one
+    void openPuzzle();  // Starts a board from a puzzle archive
+    void saveReplay();  // Writes the move log of the current game
+    void undoMove();  // Takes back the last reveal or flag
+    void customSize();  // Asks for the rows, columns and mines of the next game
 
 private:
     void initializeGame();  // Initializes and configures the game board
     void setupGame();  // Sets up the game by placing mines and configuring the grid
-    void revealCell(int row, int col);  // Reveals a cell at the given row and column
-    void revealAdjacentCells(int row, int col);  // Recursively reveals adjacent cells if they are safe
-    void updateCellDisplay(int row, int col);  // Updates the display of a cell
-    void markCell(int row, int col);  // Existing or new function to handle flagging
+    void finishAction(const std::vector<int> &revealedCells, Board::State before);  // Applies the outcome of one reveal or chord
     void updateScore();  // Method to update the score
+    void gameWon();  // Handles winning logic
     void gameOver();  // Handles game over logic
-    void findSafeCell();  // Finds a safe cell to provide as a hint to the user
+    void boardLoaded();  // Adopts the size and state of a board that was replaced as a whole
+    void setBoardSize(int newRows, int newColumns, int mines);  // Restarts with a new size, reusing every buffer
 
-    QGridLayout *gridLayout;  // Layout to arrange buttons on the grid
-    QVector<QVector<QPushButton*>> buttonGrid;  // 2D vector of buttons representing the grid cells
-    QVector<QVector<int>> mineGrid;  // 2D vector representing the mine grid, where -1 indicates a mine
-    QVector<QVector<bool>> flags;  // 2D vector tracking which cells have been flagged
+    Board board;  // Game engine holding mines, counts, revealed and flagged state
+    Solver solver;  // Deduces safe cells for hints, updated after every reveal
+    MoveLog moveLog;  // Every action of the current game, for undo and replay
+    std::vector<int> undoneCells;  // Cells the last undo changed, kept to reuse the buffer
+    std::shared_ptr<HintTask> hintTask;  // Hint computation on a snapshot of the game, run on a worker thread
+    QFutureWatcher<void> hintWatcher;  // Reports when the worker has finished the hint task
+    NoGuessGenerator generator;  // Builds layouts that can be cleared without guessing
+    PuzzleArchive archive;  // Last puzzle archive opened, kept mapped for the next puzzle
+    EndlessBoard endless;  // Unbounded field of the endless mode, generated chunk by chunk
+    IconAtlas icons;  // Cell images decoded and scaled once for the cell size
+    BoardView *boardView;  // Widget painting the whole grid
+    EndlessView *endlessView;  // Widget painting the visible part of the endless field
+    QScrollArea *scrollArea;  // Scrolls the grid when it is larger than the window
     QLabel *scoreLabel;  // Label to display the current score
     QPushButton *restartButton;  // Restart button
     QPushButton *hintButton;  // Button for providing hints
+    QCheckBox *noGuessBox;  // Whether new games must be solvable without guessing
+    QCheckBox *endlessBox;  // Whether new games use the endless field instead of the grid
+    QAction *saveAction;  // File menu entry for saving, unavailable in the endless mode
+#ifdef MINESWEEPER_PERF
+    PerfOverlay *perfOverlay;  // Timing overlay toggled with F3
+#endif
 
-    int score;  // Current score in the game
     int rows;  // Number of rows in the grid
     int columns;  // Number of columns in the grid
     int numMines;  // Number of mines on the grid
@@ -53,9 +101,9 @@ private:
     int h;  // Height of each cell in the grid
     int hintRow, hintCol;  // Coordinates for the last hinted cell
     bool hintGiven;  // Indicates whether a hint is active and not yet revealed
-    QVector<QPoint> bombCoordinates;  // Vector of points where bombs are identified
+    bool solverStale;  // Set by undo, the solver is rebuilt before it is used again
+    uint64_t gameNumber;  // Counts the games started, a new game invalidates the probability cache
+    uint64_t boardVersion;  // Changes whenever cells are revealed, hints computed for an older version are dropped
 };
 
 #endif // MAINWINDOW_H
-
-
@@ -1,13 +1,50 @@
 HEADERS += \
-    mainwindow.h
+    bitgrid.h \
+    bitset.h \
+    board.h \
+    boardview.h \
+    endless.h \
+    endlessview.h \
+    fileformat.h \
+    gamefile.h \
+    generator.h \
+    hinttask.h \
+    iconatlas.h \
+    mainwindow.h \
+    movelog.h \
+    perf.h \
+    probability.h \
+    rng.h \
+    solver.h \
+    workerpool.h
 
 SOURCES += \
+    bitgrid.cpp \
+    board.cpp \
+    boardview.cpp \
+    endless.cpp \
+    endlessview.cpp \
+    gamefile.cpp \
+    generator.cpp \
+    hinttask.cpp \
+    iconatlas.cpp \
     main.cpp \
-    mainwindow.cpp
+    mainwindow.cpp \
+    movelog.cpp \
+    perf.cpp \
+    probability.cpp \
+    solver.cpp
 
-QT += core gui widgets
+QT += core gui widgets concurrent
 
 CONFIG += c++11
 
+# qmake CONFIG+=perf builds in the timing probes, the F3 overlay and trace export; without it they compile to nothing
+CONFIG(perf) {
+    DEFINES += MINESWEEPER_PERF
+    HEADERS += perfoverlay.h
+    SOURCES += perfoverlay.cpp
+}
+
 RESOURCES += \
     resources.qrc
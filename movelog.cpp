@@ -0,0 +1,383 @@
+#include "movelog.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "fileformat.h"
+
+namespace {
+
+// Followed by the moves and then the changed cells, all little-endian like the other game files
+struct LogHeader {
+    char magic[8];  // "MSWPMOVE"
+    uint32_t version;
+    uint32_t rows;
+    uint32_t columns;
+    uint32_t mines;
+    uint64_t seed;
+    uint32_t moves;  // Number of Move records
+    uint32_t cells;  // Number of changed cells
+};
+
+static_assert(sizeof(LogHeader) == 40 && sizeof(MoveLog::Move) == 20, "Log records must not contain padding");
+static_assert(sizeof(int) == sizeof(int32_t), "Cells are stored as 32-bit integers");
+
+}
+
+MoveLog::MoveLog()
+    : rowCount(0), columnCount(0), mineCount(0), gameSeed(0), hints(0), undos(0) {
+}
+
+
+// Keeps the buffers, so a restart costs nothing however long the previous game was
+void MoveLog::start(const Board &board) {
+    moves.clear();
+    cells.clear();
+    undoable.clear();
+    rowCount = board.rows();
+    columnCount = board.columns();
+    mineCount = board.mineCount();
+    gameSeed = board.seed();
+    hints = 0;
+    undos = 0;
+    append(Start, -1, nullptr, 0, nullptr, 0);
+}
+
+
+// The log goes on, so a saved replay holds every game of the session; moves before the restart can no longer be undone
+void MoveLog::restart(const Board &board) {
+    if (moves.empty()) {
+        start(board);
+        return;
+    }
+    undoable.clear();
+    hints = 0;
+    undos = 0;
+    int game[5] = { board.rows(), board.columns(), board.mineCount(), static_cast<int>(static_cast<uint32_t>(board.seed())),
+                    static_cast<int>(static_cast<uint32_t>(board.seed() >> 32)) };
+    append(Restart, -1, game, 5, nullptr, 0);
+}
+
+
+void MoveLog::recordLayout(const std::vector<int> &mines) {
+    append(Layout, -1, mines.data(), mines.size(), nullptr, 0);
+}
+
+
+// The layers go into the cell list as they are, two entries per packed word, so the entry costs two bits per cell
+void MoveLog::recordRestore(const Board &board) {
+    size_t words = board.revealedBits().packedWords();
+    std::vector<uint64_t> layers(2 * words);
+    board.revealedBits().pack(&layers[0]);
+    board.flaggedBits().pack(&layers[words]);
+    std::vector<int> packed(4 * words);
+    std::memcpy(packed.data(), layers.data(), layers.size() * sizeof(uint64_t));
+    append(Restore, board.state(), packed.data(), 2 * words, packed.data() + 2 * words, 2 * words);
+}
+
+
+void MoveLog::recordReveal(int cell, const std::vector<int> &revealed, const Board &board, Board::State before) {
+    recordBatch(Reveal, cell, revealed, board, before);
+}
+
+
+void MoveLog::recordChord(int cell, const std::vector<int> &revealed, const Board &board, Board::State before) {
+    recordBatch(Chord, cell, revealed, board, before);
+}
+
+
+// An empty batch is only a move when it lost the game, a click on a game already over changes nothing
+void MoveLog::recordBatch(Type type, int cell, const std::vector<int> &revealed, const Board &board, Board::State before) {
+    if (revealed.empty() && board.state() == before) {
+        return;  // Nothing changed, the cell was revealed already, the number was not satisfied or the game was over
+    }
+    undoable.push_back(static_cast<uint32_t>(moves.size()));
+    const std::vector<int> &flags = board.clearedFlags();
+    append(type, cell, revealed.data(), revealed.size(), flags.data(), flags.size());
+}
+
+
+void MoveLog::recordFlag(int cell) {
+    undoable.push_back(static_cast<uint32_t>(moves.size()));
+    append(Flag, cell, nullptr, 0, nullptr, 0);
+}
+
+
+void MoveLog::recordHint(int cell) {
+    hints++;
+    append(Hint, cell, nullptr, 0, nullptr, 0);
+}
+
+
+bool MoveLog::undo(Board &board, std::vector<int> &changed) {
+    if (undoable.empty()) {
+        return false;
+    }
+    const Move &last = moves[undoable.back()];
+    revert(board, last);
+    changed.assign(cells.begin() + last.first, cells.begin() + last.first + last.revealed);
+    if (last.type == Flag) {
+        changed.push_back(last.cell);
+    }
+
+    undos++;
+    append(Undo, static_cast<int>(undoable.back()), nullptr, 0, nullptr, 0);
+    undoable.pop_back();
+    return true;
+}
+
+
+void MoveLog::append(Type type, int cell, const int *changed, size_t revealed, const int *flags, size_t cleared) {
+    Move entry;
+    entry.type = type;
+    entry.cell = cell;
+    entry.first = static_cast<uint32_t>(cells.size());
+    entry.revealed = static_cast<uint32_t>(revealed);
+    entry.cleared = static_cast<uint32_t>(cleared);
+    cells.insert(cells.end(), changed, changed + revealed);
+    cells.insert(cells.end(), flags, flags + cleared);
+    moves.push_back(entry);
+}
+
+
+void MoveLog::revert(Board &board, const Move &move) const {
+    if (move.type == Flag) {
+        board.setFlag(board.rowOf(move.cell), board.columnOf(move.cell), !board.isFlagged(move.cell));
+        return;
+    }
+    board.hideCells(&cells[move.first], move.revealed);  // Also takes back a lost game
+    for (uint32_t i = 0; i < move.cleared; ++i) {
+        int cell = cells[move.first + move.revealed + i];
+        board.setFlag(board.rowOf(cell), board.columnOf(cell), true);
+    }
+}
+
+
+// A layout must hold exactly the game's mines on distinct cells of the board, and unless a restored position
+// follows, the entry after it is the first click, whose neighbourhood placeMines() would have kept free
+bool MoveLog::readLayout(const Board &board, size_t number, std::vector<int> &mines) const {
+    const Move &entry = moves[number];
+    if (entry.revealed != static_cast<uint32_t>(board.mineCount()) || entry.cleared != 0) {
+        return false;
+    }
+    mines.assign(cells.begin() + entry.first, cells.begin() + entry.first + entry.revealed);
+    std::sort(mines.begin(), mines.end());
+    if ((!mines.empty() && (mines.front() < 0 || mines.back() >= board.cellCount())) ||
+        std::adjacent_find(mines.begin(), mines.end()) != mines.end()) {
+        return false;
+    }
+    if (number + 1 < moves.size() && moves[number + 1].type == Restore) {
+        return true;
+    }
+
+    if (number + 1 >= moves.size() || moves[number + 1].type != Reveal) {
+        return false;
+    }
+    int first = moves[number + 1].cell;
+    if (first < 0 || first >= board.cellCount()) {
+        return false;
+    }
+    int radius = board.cellCount() - board.mineCount() >= 9 ? 1 : 0;  // Same rule as placeMines()
+    for (int cell : mines) {
+        if (std::abs(board.rowOf(cell) - board.rowOf(first)) <= radius &&
+            std::abs(board.columnOf(cell) - board.columnOf(first)) <= radius) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+// A restored position must be one the engine could have reached: no mine or flag under a revealed cell,
+// nothing revealed before the mines were placed, and the game won exactly when every safe cell is revealed
+bool MoveLog::restore(Board &board, const Move &move) const {
+    size_t words = board.revealedBits().packedWords();
+    if (move.revealed != 2 * words || move.cleared != 2 * words || move.cell < Board::Playing || move.cell > Board::Lost) {
+        return false;
+    }
+    std::vector<uint64_t> layers(2 * words);
+    std::memcpy(layers.data(), &cells[move.first], layers.size() * sizeof(uint64_t));
+    board.restoreProgress(&layers[0], &layers[words], static_cast<Board::State>(move.cell));
+
+    bool consistent = board.minesPlaced() || (board.revealedCount() == 0 && board.state() == Board::Playing);
+    board.revealedBits().forEach([&](int row, int col) {
+        consistent = consistent && !board.isMine(row, col) && !board.isFlagged(row, col);
+    });
+    bool cleared = board.revealedCount() == board.cellCount() - board.mineCount();
+    return consistent && cleared == (board.state() == Board::Won);
+}
+
+
+bool MoveLog::replay(Board &board) const {
+    return replay(board, Observer());
+}
+
+
+// Every reveal must reproduce its recorded cells in the same order and every undo must take back the latest move,
+// so a log only replays if the engine, given the same seed, makes exactly the game it describes
+// A loaded game starts from its restored position, the moves that led there are not part of the log
+bool MoveLog::replay(Board &board, const Observer &beforeMove) const {
+    board.setupGame(rowCount, columnCount, mineCount, gameSeed);
+    std::vector<uint32_t> stack;
+    std::vector<int> layout;
+    for (size_t number = 0; number < moves.size(); ++number) {
+        const Move &entry = moves[number];
+        if (beforeMove) {
+            beforeMove(number, board);
+        }
+        bool inside = entry.cell >= 0 && entry.cell < board.cellCount();
+        switch (entry.type) {
+        case Start:
+            if (number != 0) {
+                return false;
+            }
+            break;
+        case Layout:
+            if (board.minesPlaced() || !readLayout(board, number, layout)) {
+                return false;
+            }
+            board.setMines(layout);
+            break;
+        case Reveal:
+        case Chord: {
+            if (!inside || board.state() != Board::Playing) {
+                return false;
+            }
+            int row = board.rowOf(entry.cell), col = board.columnOf(entry.cell);
+            const std::vector<int> &revealed = entry.type == Chord ? board.chordCell(row, col) : board.revealCell(row, col);
+            const std::vector<int> &flags = board.clearedFlags();
+            if (revealed.size() != entry.revealed || flags.size() != entry.cleared ||
+                !std::equal(revealed.begin(), revealed.end(), cells.begin() + entry.first) ||
+                !std::equal(flags.begin(), flags.end(), cells.begin() + entry.first + entry.revealed) ||
+                (revealed.empty() && board.state() != Board::Lost)) {
+                return false;
+            }
+            stack.push_back(static_cast<uint32_t>(number));
+            break;
+        }
+        case Flag:
+            if (!inside || !board.markCell(board.rowOf(entry.cell), board.columnOf(entry.cell))) {
+                return false;
+            }
+            stack.push_back(static_cast<uint32_t>(number));
+            break;
+        case Hint:
+            if (!inside) {
+                return false;
+            }
+            break;
+        case Restore:
+            // Only straight after the start, or after the layout of a game that had one
+            if ((number != 1 && (number != 2 || moves[1].type != Layout)) || !restore(board, entry)) {
+                return false;
+            }
+            break;
+        case Restart: {
+            if (entry.revealed != 5 || entry.cleared != 0) {
+                return false;
+            }
+            const int *game = &cells[entry.first];
+            if (!validFileSize(game[0], game[1]) || game[2] < 0 || game[2] >= game[0] * game[1]) {
+                return false;
+            }
+            uint64_t seed = static_cast<uint32_t>(game[3]) | static_cast<uint64_t>(static_cast<uint32_t>(game[4])) << 32;
+            board.setupGame(game[0], game[1], game[2], seed);
+            stack.clear();
+            break;
+        }
+        case Undo:
+            if (stack.empty() || stack.back() != static_cast<uint32_t>(entry.cell)) {
+                return false;
+            }
+            revert(board, moves[stack.back()]);
+            stack.pop_back();
+            break;
+        default:
+            return false;
+        }
+    }
+    return true;
+}
+
+
+bool MoveLog::save(const std::string &path) const {
+    LogHeader header;
+    std::memcpy(header.magic, "MSWPMOVE", 8);
+    header.version = fileFormatVersion;
+    header.rows = rowCount;
+    header.columns = columnCount;
+    header.mines = mineCount;
+    header.seed = gameSeed;
+    header.moves = static_cast<uint32_t>(moves.size());
+    header.cells = static_cast<uint32_t>(cells.size());
+
+    std::FILE *file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+              std::fwrite(moves.data(), sizeof(Move), moves.size(), file) == moves.size() &&
+              std::fwrite(cells.data(), sizeof(int), cells.size(), file) == cells.size();
+    return std::fclose(file) == 0 && ok;
+}
+
+
+// Only the structure is checked here, replay() decides whether the moves are legal
+bool MoveLog::load(const std::string &path) {
+    std::FILE *file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        return false;
+    }
+
+    LogHeader header;
+    bool ok = std::fread(&header, sizeof(header), 1, file) == 1 && std::memcmp(header.magic, "MSWPMOVE", 8) == 0 &&
+              header.version == fileFormatVersion && validFileSize(header.rows, header.columns) &&
+              header.mines < header.rows * header.columns;
+    std::vector<Move> entries;
+    std::vector<int> changed;
+    if (ok) {
+        entries.resize(header.moves);
+        changed.resize(header.cells);
+        ok = std::fread(entries.data(), sizeof(Move), entries.size(), file) == entries.size() &&
+             std::fread(changed.data(), sizeof(int), changed.size(), file) == changed.size();
+    }
+    std::fclose(file);
+
+    // Rebuild the counters and the undo stack, so recording can go on after the loaded moves
+    std::vector<uint32_t> stack;
+    int hintTotal = 0, undoTotal = 0;
+    for (size_t number = 0; ok && number < entries.size(); ++number) {
+        const Move &entry = entries[number];
+        ok = static_cast<uint64_t>(entry.first) + entry.revealed + entry.cleared <= changed.size();
+        if (entry.type == Reveal || entry.type == Chord || entry.type == Flag) {
+            stack.push_back(static_cast<uint32_t>(number));
+        } else if (entry.type == Restart) {
+            stack.clear();
+            hintTotal = 0;
+            undoTotal = 0;
+        } else if (entry.type == Hint) {
+            hintTotal++;
+        } else if (entry.type == Undo) {
+            ok = ok && !stack.empty();
+            if (ok) {
+                stack.pop_back();
+                undoTotal++;
+            }
+        }
+    }
+    if (!ok) {
+        return false;
+    }
+
+    moves.swap(entries);
+    cells.swap(changed);
+    undoable.swap(stack);
+    rowCount = header.rows;
+    columnCount = header.columns;
+    mineCount = header.mines;
+    gameSeed = header.seed;
+    hints = hintTotal;
+    undos = undoTotal;
+    return true;
+}
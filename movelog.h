@@ -0,0 +1,80 @@
+#ifndef MOVELOG_H
+#define MOVELOG_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include "board.h"
+
+// Append-only record of a session: every restart, reveal, flag, hint and undo becomes a compact entry holding the cells
+// it changed
+// Undo reverts exactly those cells, so it costs as much as the move did rather than a pass over the board,
+// and is itself appended, so the log keeps the whole history of the session
+// replay() runs a log through a fresh engine and checks every entry against what the engine does, which reproduces
+// bug reports and rejects logs edited to claim a better game than was played
+class MoveLog {
+public:
+    enum Type {
+        Start,  // New game, the size and seed are those of the log
+        Layout,  // Mines placed from a generated layout, its cells are the mines
+        Reveal,  // Cells revealed by a click, followed by the flagged cells among them
+        Flag,  // Flag toggled on the cell
+        Hint,  // Hint shown on the cell, the board is unchanged
+        Undo,  // Move number cell taken back
+        Chord,  // Cells revealed by chording on a number, stored like Reveal
+        Restore,  // Progress of a loaded game, its cells are the packed revealed and flag layers
+        Restart  // New game in the same log, its cells are the rows, columns, mines and the low and high half of the seed
+    };
+
+    struct Move {
+        uint32_t type;  // Type of the move
+        int32_t cell;  // Cell acted on, the move undone or the restored state
+        uint32_t first;  // Offset of the changed cells in the cell list
+        uint32_t revealed;  // Cells the move revealed
+        uint32_t cleared;  // Flags the move cleared, stored after the revealed cells
+    };
+
+    MoveLog();
+
+    void start(const Board &board);  // Clears the log for the game just set up on board
+    void restart(const Board &board);  // Appends a Restart for the game just set up on board, or starts an empty log
+    void recordLayout(const std::vector<int> &mines);
+    void recordRestore(const Board &board);  // Call after recordLayout() for a loaded game that was already in progress
+    // Call right after board.revealCell() or board.chordCell(), with the state of the game before it
+    void recordReveal(int cell, const std::vector<int> &revealed, const Board &board, Board::State before);
+    void recordChord(int cell, const std::vector<int> &revealed, const Board &board, Board::State before);
+    void recordFlag(int cell);
+    void recordHint(int cell);
+    bool undo(Board &board, std::vector<int> &changed);  // Takes back the last reveal, chord or flag, returns false if there is none
+
+    typedef std::function<void(size_t number, const Board &board)> Observer;  // Sees the board before move number
+
+    bool replay(Board &board) const;  // Plays the log on board, returns false at the first entry the engine disagrees with
+    bool replay(Board &board, const Observer &beforeMove) const;  // Same, showing every position to beforeMove
+
+    bool save(const std::string &path) const;  // Returns false if the file could not be written
+    bool load(const std::string &path);  // Returns false and leaves the log alone on any error
+
+    size_t size() const { return moves.size(); }
+    const Move &move(size_t number) const { return moves[number]; }
+    int hintCount() const { return hints; }  // In the last game of the log
+    int undoCount() const { return undos; }  // In the last game of the log
+
+private:
+    void recordBatch(Type type, int cell, const std::vector<int> &revealed, const Board &board, Board::State before);
+    void append(Type type, int cell, const int *changed, size_t revealed, const int *flags, size_t cleared);
+    void revert(Board &board, const Move &move) const;  // Restores the cells of a reveal or flag
+    bool restore(Board &board, const Move &move) const;  // Applies a Restore entry, returns false if it is inconsistent
+    bool readLayout(const Board &board, size_t number, std::vector<int> &mines) const;  // False if not the game's layout
+
+    std::vector<Move> moves;  // Every entry in the order it happened
+    std::vector<int> cells;  // Changed cells of all entries, back to back
+    std::vector<uint32_t> undoable;  // Moves that can still be undone, the last one first to go
+    int rowCount, columnCount, mineCount;  // Size of the first game, later ones follow their Restart entries
+    uint64_t gameSeed;  // Seed of the first game, which with the first click decides the layout
+    int hints;  // Hints shown since the last start or restart
+    int undos;  // Moves taken back since the last start or restart
+};
+
+#endif // MOVELOG_H
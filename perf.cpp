@@ -0,0 +1,195 @@
+#include "perf.h"
+
+#ifdef MINESWEEPER_PERF
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+
+namespace {
+
+const size_t bufferEvents = 1 << 16;  // Events kept per thread, older ones are overwritten
+const size_t windowSamples = 512;  // Frames and actions the percentiles are taken over
+
+struct Event {
+    const char *name;  // String literal given to the macro
+    int64_t start;  // Nanoseconds, see Perf::now()
+    int64_t value;  // Duration in nanoseconds for scopes, the amount added for counters
+    int thread;  // Trace thread id
+    bool counter;
+};
+
+// Ring of the recent events of one thread; the lock is only ever contended while a trace is written
+struct ThreadBuffer {
+    std::mutex lock;
+    std::vector<Event> events;
+    size_t next;  // Slot the next event goes to
+    bool inUse;  // Whether a live thread owns the buffer
+};
+
+// Rolling window of durations in nanoseconds
+struct Window {
+    int64_t samples[windowSamples];
+    size_t count;  // Samples recorded so far, the window holds the last windowSamples of them
+};
+
+std::mutex registryLock;  // Guards everything below
+std::vector<std::unique_ptr<ThreadBuffer> > buffers;  // Kept after their thread exits, a new thread reuses them
+int threadCount = 0;  // Trace thread ids handed out
+Perf::Counter *firstCounter = nullptr;
+Window frames = Window();
+Window actions = Window();
+int64_t actionStart = -1;  // Start of the action waiting for its frame, -1 for none
+
+const std::chrono::steady_clock::time_point origin = std::chrono::steady_clock::now();
+
+// Gives the calling thread a buffer on its first event and frees it for reuse when the thread exits
+struct BufferOwner {
+    ThreadBuffer *buffer;
+    int thread;
+
+    BufferOwner() {
+        std::lock_guard<std::mutex> guard(registryLock);
+        buffer = nullptr;
+        for (std::unique_ptr<ThreadBuffer> &candidate : buffers) {
+            if (!candidate->inUse) {
+                buffer = candidate.get();
+                break;
+            }
+        }
+        if (!buffer) {
+            buffers.push_back(std::unique_ptr<ThreadBuffer>(new ThreadBuffer()));
+            buffer = buffers.back().get();
+            buffer->events.reserve(bufferEvents);
+            buffer->next = 0;
+        }
+        buffer->inUse = true;
+        thread = ++threadCount;
+    }
+
+    ~BufferOwner() {
+        std::lock_guard<std::mutex> guard(registryLock);
+        buffer->inUse = false;
+    }
+};
+
+void addSample(Window &window, int64_t duration) {
+    window.samples[window.count % windowSamples] = duration;
+    window.count++;
+}
+
+Perf::Percentiles percentilesOf(const Window &window) {
+    std::vector<int64_t> sorted(window.samples, window.samples + std::min(window.count, windowSamples));
+    Perf::Percentiles result = { 0.0, 0.0, 0.0, static_cast<int>(sorted.size()) };
+    if (sorted.empty()) {
+        return result;
+    }
+    std::sort(sorted.begin(), sorted.end());
+    result.p50 = sorted[sorted.size() * 50 / 100] / 1e6;
+    result.p90 = sorted[sorted.size() * 90 / 100] / 1e6;
+    result.p99 = sorted[sorted.size() * 99 / 100] / 1e6;
+    return result;
+}
+
+}
+
+Perf::Counter::Counter(const char *name)
+    : name(name), total(0), last(0) {
+    std::lock_guard<std::mutex> guard(registryLock);
+    next = firstCounter;
+    firstCounter = this;
+}
+
+
+void Perf::Counter::add(int64_t amount) {
+    total.fetch_add(amount, std::memory_order_relaxed);
+    last.store(amount, std::memory_order_relaxed);
+    Perf::record(name, Perf::now(), amount, true);
+}
+
+
+int64_t Perf::now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - origin).count();
+}
+
+
+void Perf::record(const char *name, int64_t start, int64_t value, bool counter) {
+    thread_local BufferOwner owner;
+    ThreadBuffer &buffer = *owner.buffer;
+    Event event = { name, start, value, owner.thread, counter };
+
+    std::lock_guard<std::mutex> guard(buffer.lock);
+    if (buffer.events.size() < bufferEvents) {
+        buffer.events.push_back(event);
+    } else {
+        buffer.events[buffer.next] = event;
+    }
+    buffer.next = (buffer.next + 1) % bufferEvents;
+}
+
+
+void Perf::actionStarted() {
+    std::lock_guard<std::mutex> guard(registryLock);
+    actionStart = now();
+}
+
+
+void Perf::frameFinished(int64_t start, int64_t end) {
+    std::lock_guard<std::mutex> guard(registryLock);
+    addSample(frames, end - start);
+    if (actionStart >= 0) {
+        addSample(actions, end - actionStart);
+        actionStart = -1;
+    }
+}
+
+
+Perf::Percentiles Perf::frameTimes() {
+    std::lock_guard<std::mutex> guard(registryLock);
+    return percentilesOf(frames);
+}
+
+
+Perf::Percentiles Perf::actionLatencies() {
+    std::lock_guard<std::mutex> guard(registryLock);
+    return percentilesOf(actions);
+}
+
+
+const Perf::Counter *Perf::counters() {
+    std::lock_guard<std::mutex> guard(registryLock);
+    return firstCounter;
+}
+
+
+// Scopes become complete ("X") events and counters become counter ("C") events, timestamps in microseconds
+bool Perf::writeTrace(const std::string &path) {
+    std::FILE *file = std::fopen(path.c_str(), "w");
+    if (!file) {
+        return false;
+    }
+
+    std::fputs("{\"traceEvents\":[\n", file);
+    bool first = true;
+    std::lock_guard<std::mutex> guard(registryLock);
+    for (std::unique_ptr<ThreadBuffer> &buffer : buffers) {
+        std::lock_guard<std::mutex> bufferGuard(buffer->lock);
+        for (const Event &event : buffer->events) {
+            if (event.counter) {
+                std::fprintf(file, "%s{\"name\":\"%s\",\"ph\":\"C\",\"ts\":%.3f,\"pid\":1,\"tid\":%d,\"args\":{\"value\":%lld}}",
+                             first ? "" : ",\n", event.name, event.start / 1e3, event.thread,
+                             static_cast<long long>(event.value));
+            } else {
+                std::fprintf(file, "%s{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%d}",
+                             first ? "" : ",\n", event.name, event.start / 1e3, event.value / 1e3, event.thread);
+            }
+            first = false;
+        }
+    }
+    std::fputs("\n]}\n", file);
+    return std::fclose(file) == 0;
+}
+
+#endif // MINESWEEPER_PERF
@@ -0,0 +1,79 @@
+#ifndef PERF_H
+#define PERF_H
+
+// Optional instrumentation, compiled in only when the build defines MINESWEEPER_PERF (qmake CONFIG+=perf)
+// PERF_SCOPE(name) times the rest of the enclosing block, PERF_COUNT(name, n) adds n to a named counter,
+// PERF_ACTION(name) times a user action and starts its latency, which ends when the next PERF_FRAME() paint finishes
+// Names must be string literals; without MINESWEEPER_PERF every macro expands to an empty statement
+#ifdef MINESWEEPER_PERF
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class Perf {
+public:
+    // Times its own lifetime and records it as one trace event of the calling thread
+    class Scope {
+    public:
+        explicit Scope(const char *name) : name(name), start(Perf::now()) {}
+        ~Scope() { Perf::record(name, start, Perf::now() - start, false); }
+
+    protected:
+        const char *name;
+        int64_t start;  // Nanoseconds, see now()
+    };
+
+    // Scope around a paint, also feeds the frame times and closes the pending action latency
+    class Frame : public Scope {
+    public:
+        Frame() : Scope("paint") {}
+        ~Frame() { Perf::frameFinished(start, Perf::now()); }
+    };
+
+    // Named running total, one static instance per PERF_COUNT call site
+    class Counter {
+    public:
+        explicit Counter(const char *name);
+        void add(int64_t amount);
+
+        const char *name;
+        std::atomic<int64_t> total;  // Sum over the whole run
+        std::atomic<int64_t> last;  // Amount of the latest add
+        Counter *next;  // Next registered counter
+    };
+
+    struct Percentiles {
+        double p50, p90, p99;  // In milliseconds
+        int samples;  // Samples in the window they were taken from
+    };
+
+    static int64_t now();  // Nanoseconds since the instrumentation was first used
+    static void record(const char *name, int64_t start, int64_t value, bool counter);  // Appends to the calling thread's buffer
+    static void actionStarted();  // Starts the latency of a user action
+    static void frameFinished(int64_t start, int64_t end);
+
+    static Percentiles frameTimes();  // Paint durations over the recent frames
+    static Percentiles actionLatencies();  // Action start to end of the next paint, over the recent actions
+    static const Counter *counters();  // First registered counter, the rest follow through next
+    static bool writeTrace(const std::string &path);  // Writes every buffered event as Chrome trace JSON
+};
+
+#define PERF_CONCAT2(a, b) a##b
+#define PERF_CONCAT(a, b) PERF_CONCAT2(a, b)
+#define PERF_SCOPE(name) Perf::Scope PERF_CONCAT(perfScope, __LINE__)(name)
+#define PERF_FRAME() Perf::Frame PERF_CONCAT(perfFrame, __LINE__)
+#define PERF_ACTION(name) Perf::actionStarted(); Perf::Scope PERF_CONCAT(perfAction, __LINE__)(name)
+#define PERF_COUNT(name, amount) do { static Perf::Counter perfCounter(name); perfCounter.add(amount); } while (0)
+
+#else
+
+#define PERF_SCOPE(name) do { } while (0)
+#define PERF_FRAME() do { } while (0)
+#define PERF_ACTION(name) do { } while (0)
+#define PERF_COUNT(name, amount) do { (void)sizeof(amount); } while (0)  // Keeps variables used only for counting used
+
+#endif // MINESWEEPER_PERF
+
+#endif // PERF_H
@@ -0,0 +1,65 @@
+#include "perfoverlay.h"
+
+#include <QPainter>
+#include <QStringList>
+#include <algorithm>
+#include "perf.h"
+
+static const int refreshMs = 250;
+
+PerfOverlay::PerfOverlay(QWidget *parent)
+    : QWidget(parent), timerId(0) {
+    setAttribute(Qt::WA_TransparentForMouseEvents);  // Clicks go through to the board
+    hide();
+}
+
+
+void PerfOverlay::toggle() {
+    if (isVisible()) {
+        killTimer(timerId);
+        hide();
+        return;
+    }
+    timerId = startTimer(refreshMs);
+    raise();
+    show();
+    update();
+}
+
+
+void PerfOverlay::timerEvent(QTimerEvent *) {
+    update();
+}
+
+
+// Sizes itself to the text, so the panel covers as little of the board as possible
+void PerfOverlay::paintEvent(QPaintEvent *) {
+    Perf::Percentiles frames = Perf::frameTimes();
+    Perf::Percentiles actions = Perf::actionLatencies();
+    QStringList lines;
+    lines << QString("frame   p50 %1  p90 %2  p99 %3 ms (%4)").arg(frames.p50, 0, 'f', 2).arg(frames.p90, 0, 'f', 2)
+                 .arg(frames.p99, 0, 'f', 2).arg(frames.samples);
+    lines << QString("action  p50 %1  p90 %2  p99 %3 ms (%4)").arg(actions.p50, 0, 'f', 2).arg(actions.p90, 0, 'f', 2)
+                 .arg(actions.p99, 0, 'f', 2).arg(actions.samples);
+    for (const Perf::Counter *counter = Perf::counters(); counter; counter = counter->next) {
+        lines << QString("%1: last %2, total %3").arg(counter->name).arg(static_cast<qlonglong>(counter->last.load()))
+                     .arg(static_cast<qlonglong>(counter->total.load()));
+    }
+
+    QFontMetrics metrics(font());
+    QSize needed(0, metrics.height() * lines.size() + 8);
+    for (const QString &line : lines) {
+        needed.setWidth(std::max(needed.width(), metrics.boundingRect(line).width() + 12));
+    }
+    if (size() != needed) {
+        resize(needed);  // Paints again at the new size
+        return;
+    }
+
+    QPainter painter(this);
+    painter.fillRect(rect(), QColor(0, 0, 0, 170));
+    painter.setPen(Qt::white);
+    for (int i = 0; i < lines.size(); ++i) {
+        painter.drawText(6, 4 + metrics.ascent() + i * metrics.height(), lines[i]);
+    }
+}
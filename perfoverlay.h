@@ -0,0 +1,24 @@
+#ifndef PERFOVERLAY_H
+#define PERFOVERLAY_H
+
+#include <QWidget>
+#include <QPaintEvent>
+#include <QTimerEvent>
+
+// Translucent panel over the top left of its parent showing frame times, action latency percentiles and the counters
+// Only built with CONFIG+=perf; it refreshes a few times per second while shown and ignores the mouse
+class PerfOverlay : public QWidget {
+public:
+    explicit PerfOverlay(QWidget *parent);
+
+    void toggle();  // Shows or hides the overlay
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void timerEvent(QTimerEvent *event) override;  // Repaints with the latest numbers
+
+private:
+    int timerId;  // Refresh timer, only running while shown
+};
+
+#endif // PERFOVERLAY_H
@@ -0,0 +1,523 @@
+#include "probability.h"
+
+#include <algorithm>
+#include <cmath>
+#include "perf.h"
+
+struct ProbabilitySolver::Enumeration {
+    std::vector<std::vector<int>> cellConstraints;  // Local constraint indices of each cell
+    std::vector<int> needed;  // Mines each constraint still needs
+    std::vector<int> open;  // Unassigned cells of each constraint
+    std::vector<char> value;  // Current assignment, 1 for a mine
+    std::vector<double> configs;  // Configurations found so far, by mine count
+    std::vector<double> cellMines;  // Per mine count and cell, configurations where the cell is a mine
+    long nodes;  // Search nodes visited, used to poll the clock sparingly
+};
+
+
+void ProbabilitySolver::reset() {
+    cache.clear();
+}
+
+
+// Finds the mine counts a group of cells can have, [first, end) holds every non-zero entry of its polynomial
+static void support(const std::vector<double> &counts, size_t &first, size_t &end) {
+    first = 0;
+    end = counts.size();
+    while (first < end && counts[first] == 0.0) {
+        first++;
+    }
+    while (end > first && counts[end - 1] == 0.0) {
+        end--;
+    }
+}
+
+
+// Scales the largest entry to one, only ratios matter and rescaling keeps long products inside double range
+static void normalise(std::vector<double> &values) {
+    double largest = values.empty() ? 0.0 : *std::max_element(values.begin(), values.end());
+    if (largest > 0.0) {
+        for (double &v : values) {
+            v /= largest;
+        }
+    }
+}
+
+
+// Multiplies the mine count polynomials of two groups of cells
+// A large group can only hold a narrow band of mine counts, so only the supports are multiplied
+static std::vector<double> convolve(const std::vector<double> &a, const std::vector<double> &b) {
+    std::vector<double> result(a.size() + b.size() - 1, 0.0);
+    size_t aFirst, aEnd, bFirst, bEnd;
+    support(a, aFirst, aEnd);
+    support(b, bFirst, bEnd);
+    for (size_t i = aFirst; i < aEnd; ++i) {
+        for (size_t j = bFirst; j < bEnd; ++j) {
+            result[i + j] += a[i] * b[j];
+        }
+    }
+    normalise(result);
+    return result;
+}
+
+
+// Sums the ways to complete a group of cells: result[t] = sum over j of other[j] * outside[t + j], for every mine
+// count t the group itself can have
+static std::vector<double> correlate(const std::vector<double> &other, const std::vector<double> &outside,
+                                     const std::vector<double> &group) {
+    std::vector<double> result(group.size(), 0.0);
+    size_t first, end, otherFirst, otherEnd;
+    support(group, first, end);
+    support(other, otherFirst, otherEnd);
+    for (size_t t = first; t < end; ++t) {
+        for (size_t j = otherFirst; j < otherEnd && t + j < outside.size(); ++j) {
+            result[t] += other[j] * outside[t + j];
+        }
+    }
+    normalise(result);
+    return result;
+}
+
+
+uint64_t ProbabilitySolver::hashKey(const std::vector<int> &key) {
+    uint64_t hash = 0xCBF29CE484222325ULL;  // FNV-1a over the key values
+    for (int value : key) {
+        hash ^= static_cast<uint32_t>(value);
+        hash *= 0x100000001B3ULL;
+    }
+    return hash;
+}
+
+
+// Links frontier numbers that share an unknown cell, each connected group is counted on its own
+void ProbabilitySolver::buildComponents(const Board &board, const Solver &solver) {
+    const std::vector<int> &frontier = solver.frontier();
+    std::vector<Solver::Constraint> constraints(frontier.size());
+    std::vector<int> parent(frontier.size());
+    componentOf.assign(board.cellCount(), -1);  // Temporarily holds the first constraint seen for each cell
+
+    for (size_t i = 0; i < frontier.size(); ++i) {
+        constraints[i] = solver.constraintOf(board, frontier[i]);
+        parent[i] = static_cast<int>(i);
+    }
+
+    auto find = [&parent](int i) {
+        while (parent[i] != i) {
+            parent[i] = parent[parent[i]];
+            i = parent[i];
+        }
+        return i;
+    };
+    for (size_t i = 0; i < frontier.size(); ++i) {
+        for (int k = 0; k < constraints[i].size; ++k) {
+            int cell = constraints[i].unknown[k];
+            if (componentOf[cell] < 0) {
+                componentOf[cell] = static_cast<int>(i);
+            } else {
+                parent[find(static_cast<int>(i))] = find(componentOf[cell]);
+            }
+        }
+    }
+
+    // Frontier numbers are stored in a stable order, so equal components always produce equal keys
+    std::vector<int> order(frontier.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        order[i] = static_cast<int>(i);
+    }
+    std::sort(order.begin(), order.end(), [&frontier](int a, int b) { return frontier[a] < frontier[b]; });
+
+    components.clear();
+    std::vector<int> componentIndex(frontier.size(), -1);
+    for (int i : order) {
+        if (constraints[i].size == 0) {
+            continue;
+        }
+        int root = find(i);
+        if (componentIndex[root] < 0) {
+            componentIndex[root] = static_cast<int>(components.size());
+            components.push_back(Component());
+        }
+        Component &component = components[componentIndex[root]];
+        component.constraints.push_back(frontier[i]);
+        component.key.push_back(frontier[i]);
+        component.key.push_back(constraints[i].mines);
+        component.key.push_back(constraints[i].size);
+        for (int k = 0; k < constraints[i].size; ++k) {
+            component.key.push_back(constraints[i].unknown[k]);
+        }
+    }
+
+    // Number the cells of each component in the order their constraints appear, which closes constraints early
+    for (size_t c = 0; c < components.size(); ++c) {
+        Component &component = components[c];
+        for (int constraintCell : component.constraints) {
+            Solver::Constraint constraint = solver.constraintOf(board, constraintCell);
+            for (int k = 0; k < constraint.size; ++k) {
+                int cell = constraint.unknown[k];
+                if (componentOf[cell] != -2 - static_cast<int>(c)) {
+                    componentOf[cell] = -2 - static_cast<int>(c);  // Mark as numbered for this component
+                    component.cells.push_back(cell);
+                }
+            }
+        }
+    }
+    for (size_t c = 0; c < components.size(); ++c) {
+        for (int cell : components[c].cells) {
+            componentOf[cell] = static_cast<int>(c);
+        }
+    }
+}
+
+
+// Counts every consistent assignment of the component's cells, grouped by the number of mines it uses
+void ProbabilitySolver::countComponent(const Board &board, const Solver &solver, Component &component) {
+    int size = static_cast<int>(component.cells.size());
+    Enumeration state;
+    state.cellConstraints.assign(size, std::vector<int>());
+    state.needed.resize(component.constraints.size());
+    state.open.resize(component.constraints.size());
+    state.value.assign(size, 0);
+    state.configs.assign(size + 1, 0.0);
+    state.cellMines.assign((size + 1) * size, 0.0);
+    state.nodes = 0;
+
+    std::unordered_map<int, int> localIndex;
+    for (int i = 0; i < size; ++i) {
+        localIndex[component.cells[i]] = i;
+    }
+    for (size_t c = 0; c < component.constraints.size(); ++c) {
+        Solver::Constraint constraint = solver.constraintOf(board, component.constraints[c]);
+        state.needed[c] = constraint.mines;
+        state.open[c] = constraint.size;
+        for (int k = 0; k < constraint.size; ++k) {
+            state.cellConstraints[localIndex[constraint.unknown[k]]].push_back(static_cast<int>(c));
+        }
+    }
+
+    backtrack(state, 0, 0);
+
+    component.configs.swap(state.configs);
+    component.cellMines.swap(state.cellMines);
+    component.exact = !outOfTime;
+}
+
+
+bool ProbabilitySolver::pastDeadline() {
+    outOfTime = outOfTime || std::chrono::steady_clock::now() > deadline;
+    return outOfTime;
+}
+
+
+void ProbabilitySolver::backtrack(Enumeration &state, int depth, int mines) {
+    if (outOfTime || ((++state.nodes & 4095) == 0 && pastDeadline())) {
+        return;
+    }
+
+    int size = static_cast<int>(state.value.size());
+    if (depth == size) {
+        state.configs[mines] += 1.0;
+        for (int i = 0; i < size; ++i) {
+            if (state.value[i]) {
+                state.cellMines[mines * size + i] += 1.0;
+            }
+        }
+        return;
+    }
+
+    const std::vector<int> &constraints = state.cellConstraints[depth];
+    for (int value = 0; value <= 1; ++value) {
+        // A value is allowed if every constraint on the cell can still be met exactly
+        bool consistent = true;
+        for (int c : constraints) {
+            int needed = state.needed[c] - value;
+            if (needed < 0 || needed > state.open[c] - 1) {
+                consistent = false;
+                break;
+            }
+        }
+        if (!consistent) {
+            continue;
+        }
+
+        for (int c : constraints) {
+            state.needed[c] -= value;
+            state.open[c]--;
+        }
+        state.value[depth] = static_cast<char>(value);
+        backtrack(state, depth + 1, mines + value);
+        for (int c : constraints) {
+            state.needed[c] += value;
+            state.open[c]++;
+        }
+    }
+    state.value[depth] = 0;
+}
+
+
+// Fallback for a component whose enumeration did not finish: each cell gets the average density of the numbers
+// around it, remaining mines over unknown cells, which is neutral where a partial count would be biased or empty
+double ProbabilitySolver::estimateComponent(const Board &board, const Solver &solver, const Component &component) {
+    std::unordered_map<int, int> localIndex;
+    for (size_t i = 0; i < component.cells.size(); ++i) {
+        localIndex[component.cells[i]] = static_cast<int>(i);
+    }
+    std::vector<double> density(component.cells.size(), 0.0);
+    std::vector<int> seen(component.cells.size(), 0);
+    for (int constraintCell : component.constraints) {
+        Solver::Constraint constraint = solver.constraintOf(board, constraintCell);
+        for (int k = 0; k < constraint.size; ++k) {
+            int i = localIndex[constraint.unknown[k]];
+            density[i] += static_cast<double>(constraint.mines) / constraint.size;
+            seen[i]++;
+        }
+    }
+
+    double expected = 0.0;
+    for (size_t i = 0; i < component.cells.size(); ++i) {
+        double probability = seen[i] > 0 ? std::min(1.0, std::max(0.0, density[i] / seen[i])) : 0.5;
+        heatMap[component.cells[i]] = static_cast<float>(probability);
+        expected += probability;
+    }
+    return expected;
+}
+
+
+// Sets the probability of every cell of a component from the weight of it holding k mines, returns its expected mines
+double ProbabilitySolver::applyComponent(const Component &component, const std::vector<double> &combined) {
+    int size = static_cast<int>(component.cells.size());
+    double total = 0.0, expected = 0.0;
+    for (int k = 0; k <= size; ++k) {
+        total += component.configs[k] * combined[k];
+    }
+    for (int i = 0; i < size; ++i) {
+        double mines = 0.0;
+        for (int k = 0; k <= size; ++k) {
+            mines += component.cellMines[k * size + i] * combined[k];
+        }
+        double probability = total > 0.0 ? mines / total : 0.5;
+        heatMap[component.cells[i]] = static_cast<float>(probability);
+        expected += probability;
+    }
+    return expected;
+}
+
+
+// Combines the components with the remaining mines: a total of f frontier mines leaves
+// C(interior, remaining - f) ways to place the rest, which weights every frontier configuration
+ProbabilitySolver::Result ProbabilitySolver::solve(const Board &board, const Solver &solver, double budgetMs) {
+    PERF_SCOPE("probabilities");
+    Result result = {-1, 1.0, true};
+    int n = board.cellCount();
+    heatMap.assign(n, -1.0f);
+
+    if (!board.minesPlaced()) {  // The first reveal is always safe
+        for (int cell = 0; cell < n; ++cell) {
+            heatMap[cell] = 0.0f;
+        }
+        result.bestCell = board.index(board.rows() / 2, board.columns() / 2);
+        result.bestProbability = 0.0;
+        return result;
+    }
+
+    deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(static_cast<long long>(budgetMs * 1000.0));
+    outOfTime = false;
+    buildComponents(board, solver);
+
+    // Count each component, reusing the counts of components left unchanged since the previous solve
+    std::unordered_map<uint64_t, Component> counted;
+    for (Component &component : components) {
+        if (pastDeadline()) {
+            component.exact = false;  // Not even looked up, a cached count of a large component is costly to copy
+            result.exact = false;
+            continue;
+        }
+        uint64_t hash = hashKey(component.key);
+        std::unordered_map<uint64_t, Component>::iterator hit = cache.find(hash);
+        if (hit != cache.end() && hit->second.key == component.key) {
+            component.configs = hit->second.configs;
+            component.cellMines = hit->second.cellMines;
+            component.exact = true;
+        } else {
+            countComponent(board, solver, component);
+        }
+        if (component.exact) {
+            counted[hash] = component;
+        } else {
+            result.exact = false;  // This component is estimated below instead
+        }
+
+        double largest = *std::max_element(component.configs.begin(), component.configs.end());
+        if (largest > 0.0) {
+            for (double &v : component.configs) {
+                v /= largest;
+            }
+            for (double &v : component.cellMines) {
+                v /= largest;
+            }
+        }
+    }
+    cache.swap(counted);  // Keep only what the current position uses
+
+    // Unfinished components drop out of the exact combination, keeping the mines they are expected to hold
+    double estimatedMines = 0.0;
+    std::vector<int> exact;  // Components taking part in the combination
+    for (size_t c = 0; c < components.size(); ++c) {
+        if (components[c].exact) {
+            exact.push_back(static_cast<int>(c));
+        } else {
+            estimatedMines += estimateComponent(board, solver, components[c]);
+        }
+    }
+
+    int remaining = board.mineCount();
+    int interior = 0;
+    for (int cell = 0; cell < n; ++cell) {
+        if (board.isRevealed(cell)) {
+            continue;
+        }
+        if (solver.isKnownMine(cell)) {
+            remaining--;
+        } else if (!solver.isKnownSafe(cell) && componentOf[cell] < 0) {
+            interior++;
+        }
+    }
+
+    // Relative weight of having f mines on the frontier
+    int frontierCells = 0;
+    for (int c : exact) {
+        frontierCells += static_cast<int>(components[c].cells.size());
+    }
+    remaining = std::max(0, std::min(interior + frontierCells, remaining - static_cast<int>(estimatedMines + 0.5)));
+    // Only the ratios matter, so log C(interior, rest) is stepped through C(n, k - 1) = C(n, k) * k / (n - k + 1)
+    // instead of calling lgamma, which writes the global signgam and so is not safe to call from several threads
+    std::vector<double> weight(frontierCells + 1, 0.0);
+    std::vector<double> logWeight(frontierCells + 1, -HUGE_VAL);
+    double maxLog = -HUGE_VAL;
+    double logCount = 0.0;  // Relative to the first valid f
+    bool started = false;
+    for (int f = 0; f <= frontierCells; ++f) {
+        int rest = remaining - f;
+        if (rest < 0) {
+            break;
+        }
+        if (rest > interior) {
+            continue;
+        }
+        if (started) {
+            logCount += std::log(rest + 1.0) - std::log(static_cast<double>(interior - rest));
+        }
+        started = true;
+        logWeight[f] = logCount;
+        maxLog = std::max(maxLog, logCount);
+    }
+    for (int f = 0; f <= frontierCells; ++f) {
+        if (logWeight[f] > -HUGE_VAL) {
+            weight[f] = std::exp(logWeight[f] - maxLog);
+        }
+    }
+
+    // Components are combined through a balanced tree of partial products. Going down, each node receives the
+    // weighted count of every way to complete it from outside its subtree, so all components are combined in
+    // O(frontier^2) overall instead of once per component
+    size_t count = exact.size();
+    std::vector<std::vector<double>> product;  // Mine count polynomial of each tree node, leaves first
+    std::vector<std::pair<int, int>> children;  // Children of each internal node, stored after the leaves
+    for (size_t c = 0; c < count; ++c) {
+        product.push_back(components[exact[c]].configs);
+    }
+    std::vector<int> level;
+    for (size_t c = 0; c < count; ++c) {
+        level.push_back(static_cast<int>(c));
+    }
+    while (level.size() > 1 && !pastDeadline()) {
+        std::vector<int> next;
+        for (size_t i = 0; i + 1 < level.size(); i += 2) {
+            next.push_back(static_cast<int>(product.size()));
+            product.push_back(convolve(product[level[i]], product[level[i + 1]]));
+            children.push_back(std::make_pair(level[i], level[i + 1]));
+        }
+        if (level.size() % 2) {
+            next.push_back(level.back());
+        }
+        level.swap(next);
+    }
+    bool combined = level.size() <= 1;  // False when the budget ran out while the tree was built
+    std::vector<double> all = count > 0 ? product.back() : std::vector<double>(1, 1.0);  // Whole frontier, once combined
+
+    // The estimate can leave a mine count no frontier configuration agrees with; the count is then ignored
+    // rather than letting every total collapse to zero
+    double feasible = 0.0;
+    for (size_t f = 0; combined && f < all.size() && f < weight.size(); ++f) {
+        feasible += all[f] * weight[f];
+    }
+    if (combined && feasible <= 0.0) {
+        std::fill(weight.begin(), weight.end(), 1.0);
+    }
+
+    std::vector<std::vector<double>> outside(product.size());
+    if (combined && count > 0) {
+        outside.back() = std::vector<double>(weight.begin(), weight.begin() + product.back().size());
+    }
+    for (size_t node = product.size(); combined && node > count; --node) {
+        if (pastDeadline()) {
+            combined = false;
+            break;
+        }
+        const std::vector<double> &parent = outside[node - 1];
+        const std::pair<int, int> &pair = children[node - 1 - count];
+        outside[pair.first] = correlate(product[pair.second], parent, product[pair.first]);
+        outside[pair.second] = correlate(product[pair.first], parent, product[pair.second]);
+    }
+
+    // Past the deadline every component is weighted on its own instead: each further mine costs the odds of a mine
+    // among all the unresolved cells, which is what the combination tends to when the other cells are many
+    double density = std::min(0.999, std::max(0.001, static_cast<double>(remaining) / std::max(1, interior + frontierCells)));
+    double logOdds = std::log(density / (1.0 - density));
+    std::vector<double> local;
+    double frontierMines = 0.0;  // Expected mines on the combined components
+    if (!combined) {
+        result.exact = false;
+    }
+    for (size_t c = 0; c < count; ++c) {
+        const Component &component = components[exact[c]];
+        if (!combined) {
+            local.resize(component.configs.size());
+            double top = logOdds > 0.0 ? static_cast<double>(local.size() - 1) : 0.0;  // Largest weight is one
+            for (size_t k = 0; k < local.size(); ++k) {
+                local[k] = std::exp((static_cast<double>(k) - top) * logOdds);
+            }
+        }
+        frontierMines += applyComponent(component, combined ? outside[c] : local);
+    }
+
+    // Expected density of the cells no number touches
+    double interiorProbability = 0.0;
+    if (interior > 0 && combined) {
+        double mines = 0.0, total = 0.0;
+        for (size_t f = 0; f < all.size() && f < weight.size(); ++f) {
+            total += all[f] * weight[f];
+            mines += all[f] * weight[f] * (remaining - static_cast<int>(f));
+        }
+        interiorProbability = total > 0.0 ? std::min(1.0, std::max(0.0, mines / total / interior)) : 0.0;
+    } else if (interior > 0) {
+        interiorProbability = std::min(1.0, std::max(0.0, (remaining - frontierMines) / interior));
+    }
+
+    for (int cell = 0; cell < n; ++cell) {
+        if (board.isRevealed(cell)) {
+            continue;
+        }
+        if (solver.isKnownMine(cell)) {
+            heatMap[cell] = 1.0f;
+        } else if (solver.isKnownSafe(cell)) {
+            heatMap[cell] = 0.0f;
+        } else if (componentOf[cell] < 0) {
+            heatMap[cell] = static_cast<float>(interiorProbability);
+        }
+        if (!solver.isKnownMine(cell) && (result.bestCell < 0 || heatMap[cell] < result.bestProbability)) {
+            result.bestProbability = heatMap[cell];
+            result.bestCell = cell;
+        }
+    }
+    return result;
+}
@@ -0,0 +1,59 @@
+#ifndef PROBABILITY_H
+#define PROBABILITY_H
+
+#include <chrono>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "board.h"
+#include "solver.h"
+
+// Computes the exact mine probability of every hidden cell when no cell is provably safe
+// The frontier is split into independent components; the mine configurations of each one are counted by
+// backtracking and combined with the number of ways to place the remaining mines on the unconstrained cells
+// Component counts are cached by their constraints, so components a move did not touch are not enumerated again
+// A component whose enumeration runs out of time is left out of the product; its cells get the mine density of the
+// numbers around them, and the mines they are expected to hold are taken off the remaining count
+// The clock is also checked before each component and between the steps that combine them; once the budget is spent,
+// components are no longer looked up or counted, and counted ones are weighted on their own rather than combined
+class ProbabilitySolver {
+public:
+    struct Result {
+        int bestCell;  // Hidden cell least likely to be a mine, -1 if there is none
+        double bestProbability;  // Mine probability of bestCell
+        bool exact;  // False when the time budget ran out and some probabilities are estimates
+    };
+
+    void reset();  // Forgets the cached components, call when a new game starts
+    Result solve(const Board &board, const Solver &solver, double budgetMs);  // The solver must be up to date
+    const std::vector<float> &probabilities() const { return heatMap; }  // Per-cell mine probability, -1 for revealed cells
+
+private:
+    struct Component {
+        std::vector<int> key;  // Constraint cells, their remaining mines and unknown cells, identifies the component
+        std::vector<int> cells;  // Unknown cells, in enumeration order
+        std::vector<int> constraints;  // Revealed numbers constraining the cells
+        std::vector<double> configs;  // Number of consistent configurations with k mines
+        std::vector<double> cellMines;  // Configurations with k mines where cell i is a mine, at [k * cells.size() + i]
+        bool exact;  // Whether the enumeration finished within the budget
+    };
+
+    struct Enumeration;  // Scratch state of one backtracking run
+
+    void buildComponents(const Board &board, const Solver &solver);  // Groups the frontier into independent components
+    void countComponent(const Board &board, const Solver &solver, Component &component);  // Fills configs and cellMines
+    void backtrack(Enumeration &state, int depth, int mines);  // Tries both values for the cell at depth
+    double estimateComponent(const Board &board, const Solver &solver, const Component &component);  // Returns its mines
+    double applyComponent(const Component &component, const std::vector<double> &combined);  // Returns its mines
+    bool pastDeadline();  // Polls the clock, sets outOfTime once the deadline has passed
+    static uint64_t hashKey(const std::vector<int> &key);  // Cache key of a component
+
+    std::vector<Component> components;  // Components of the current position
+    std::unordered_map<uint64_t, Component> cache;  // Counted components of the previous solve, by signature
+    std::vector<float> heatMap;  // Result of the last solve
+    std::vector<int> componentOf;  // Component index of each unknown frontier cell, -1 otherwise
+    std::chrono::steady_clock::time_point deadline;  // When enumeration must stop
+    bool outOfTime;  // Set once the deadline has passed
+};
+
+#endif // PROBABILITY_H
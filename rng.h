@@ -0,0 +1,59 @@
+#ifndef RNG_H
+#define RNG_H
+
+#include <cstdint>
+
+// splitmix64 finaliser: every input bit affects every output bit, so consecutive inputs give unrelated seeds
+inline uint64_t mixSeed(uint64_t z) {
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// Small, fast and reproducible pseudo random generator (xoshiro256**)
+// The same seed yields the same sequence on every platform and standard library
+class Rng {
+public:
+    explicit Rng(uint64_t seed) { reseed(seed); }
+
+    // Expands the seed into the full state with splitmix64, as recommended by the xoshiro authors
+    void reseed(uint64_t seed) {
+        for (int i = 0; i < 4; ++i) {
+            seed += 0x9E3779B97F4A7C15ULL;
+            state[i] = mixSeed(seed);
+        }
+    }
+
+    uint64_t next() {
+        uint64_t result = rotl(state[1] * 5, 7) * 9;
+        uint64_t t = state[1] << 17;
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= t;
+        state[3] = rotl(state[3], 45);
+        return result;
+    }
+
+    // Returns a uniformly distributed value in [0, bound) using Lemire's multiply-shift method
+    uint32_t bounded(uint32_t bound) {
+        uint64_t product = (next() >> 32) * bound;
+        uint32_t low = static_cast<uint32_t>(product);
+        if (low < bound) {
+            uint32_t threshold = static_cast<uint32_t>(-bound) % bound;
+            while (low < threshold) {  // Reject the few values that would bias the result
+                product = (next() >> 32) * bound;
+                low = static_cast<uint32_t>(product);
+            }
+        }
+        return static_cast<uint32_t>(product >> 32);
+    }
+
+private:
+    static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+    uint64_t state[4];  // Generator state, never all zero
+};
+
+#endif // RNG_H
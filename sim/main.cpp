@@ -0,0 +1,220 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "analysis.h"
+#include "board.h"
+#include "gamefile.h"
+#include "movelog.h"
+#include "simulator.h"
+
+// Prints the command line options
+static void printUsage(const char *program) {
+    std::printf("Usage: %s [options]\n"
+                "  --games N      number of games to play (default 100000)\n"
+                "  --rows N       board rows (default 16)\n"
+                "  --columns N    board columns (default 30)\n"
+                "  --mines N      mines per board (default 99)\n"
+                "  --seed N       base seed (default 1)\n"
+                "  --threads N    worker threads, 0 for one per core (default 0)\n"
+                "  --budget MS    time budget per guess in milliseconds (default 10)\n"
+                "  --no-guess     play boards generated to need no guess\n"
+                "  --archive FILE play the boards of a puzzle archive instead of generating them\n"
+                "  --write-archive FILE\n"
+                "                 write the boards to a puzzle archive instead of playing them\n"
+                "  --replay FILE  check a game recorded by the GUI and print its result\n"
+                "  --analyze FILE score every reveal of a recorded game: proved cells, forced guesses and risk\n", program);
+}
+
+// Replays a recorded game on a fresh engine, the exit code tells whether the log is consistent
+static int replayGame(const char *path) {
+    MoveLog log;
+    if (!log.load(path)) {
+        std::fprintf(stderr, "Could not read replay %s\n", path);
+        return 1;
+    }
+
+    Board board;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    bool consistent = log.replay(board);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    static const char *const states[] = { "playing", "won", "lost" };
+    std::printf("board:         %dx%d, %d mines\n", board.rows(), board.columns(), board.mineCount());
+    std::printf("consistent:    %s\n", consistent ? "yes" : "no");
+    std::printf("state:         %s\n", states[board.state()]);
+    std::printf("score:         %d\n", board.revealedCount());
+    std::printf("moves:         %zu\n", log.size());
+    std::printf("hints:         %d\n", log.hintCount());
+    std::printf("undos:         %d\n", log.undoCount());
+    std::printf("elapsed:       %.6f s\n", seconds);
+    return consistent ? 0 : 2;
+}
+
+// Captures the position before every reveal and chord of a recorded game and analyses them as one batch
+static int analyzeGame(const char *path, int threads) {
+    MoveLog log;
+    if (!log.load(path)) {
+        std::fprintf(stderr, "Could not read replay %s\n", path);
+        return 1;
+    }
+
+    Board board;
+    std::vector<size_t> numbers;  // Move each captured position comes before
+    std::vector<uint64_t> layers;  // Mine and revealed layer of every position, back to back
+    size_t words = 0;
+    bool consistent = log.replay(board, [&](size_t number, const Board &position) {
+        uint32_t type = log.move(number).type;
+        if (type == MoveLog::Restart) {
+            numbers.clear();  // Only the last game of the log is analysed, earlier ones may have another size
+            layers.clear();
+            return;
+        }
+        if ((type != MoveLog::Reveal && type != MoveLog::Chord) || !position.minesPlaced() ||
+            position.state() != Board::Playing) {
+            return;  // The first click of a game is always safe, there is nothing to score
+        }
+        words = PositionAnalyzer::layerWords(position.rows(), position.columns());
+        layers.resize(layers.size() + 2 * words);
+        PositionAnalyzer::capture(position, &layers[layers.size() - 2 * words], &layers[layers.size() - words]);
+        numbers.push_back(number);
+    });
+    if (!consistent) {
+        std::fprintf(stderr, "Replay %s does not match the engine\n", path);
+        return 2;
+    }
+
+    std::vector<PositionAnalyzer::Position> positions(numbers.size());
+    for (size_t i = 0; i < numbers.size(); ++i) {
+        PositionAnalyzer::Position position = { board.rows(), board.columns(), &layers[2 * i * words],
+                                                &layers[(2 * i + 1) * words] };
+        positions[i] = position;
+    }
+    std::vector<PositionAnalyzer::Analysis> results(positions.size());
+    PositionAnalyzer::Options options = PositionAnalyzer::defaultOptions();
+    options.probabilities = PositionAnalyzer::AllPositions;  // The risk of every click, not only forced ones
+    options.threads = threads;
+    PositionAnalyzer analyzer;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    analyzer.analyze(positions.data(), positions.size(), results.data(), options);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // A click is risky when it went to a cell that was not proved safe, whether or not a safe cell existed
+    int forced = 0, risky = 0;
+    std::printf("move    cell   safe  mines  forced  risk\n");
+    for (size_t i = 0; i < results.size(); ++i) {
+        const PositionAnalyzer::Analysis &result = results[i];
+        int cell = log.move(numbers[i]).cell;
+        double risk = result.probabilities.empty() ? 0.0 : std::max(0.0f, result.probabilities[cell]);
+        forced += result.guessForced;
+        risky += risk > 0.0;
+        std::printf("%-7zu %-6d %-5zu %-6zu %-7s %.3f\n", numbers[i], cell, result.safeCells.size(),
+                    result.mineCells.size(), result.guessForced ? "yes" : "no", risk);
+    }
+    std::printf("positions:     %zu\n", results.size());
+    std::printf("forced:        %d\n", forced);
+    std::printf("risky clicks:  %d\n", risky);
+    std::printf("elapsed:       %.6f s\n", seconds);
+    return 0;
+}
+
+int main(int argc, char *argv[]) {  // Entry point of the headless batch simulator
+    Simulator::Options options;
+    options.rows = 16;
+    options.columns = 30;
+    options.mines = 99;
+    options.seed = 1;
+    options.games = 100000;
+    options.threads = 0;
+    options.guessBudgetMs = 10.0;
+    options.noGuess = false;
+    options.archive = nullptr;
+    const char *archivePath = nullptr;
+    const char *writePath = nullptr;
+
+    for (int i = 1; i < argc; ++i) {
+        const char *arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (std::strcmp(arg, "--help") == 0) {
+            printUsage(argv[0]);
+            return 0;
+        }
+        if (std::strcmp(arg, "--no-guess") == 0) {  // The only option without a value
+            options.noGuess = true;
+            continue;
+        }
+        if (!value) {
+            printUsage(argv[0]);
+            return 1;
+        }
+        if (std::strcmp(arg, "--games") == 0) {
+            options.games = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+        } else if (std::strcmp(arg, "--rows") == 0) {
+            options.rows = std::atoi(value);
+        } else if (std::strcmp(arg, "--columns") == 0) {
+            options.columns = std::atoi(value);
+        } else if (std::strcmp(arg, "--mines") == 0) {
+            options.mines = std::atoi(value);
+        } else if (std::strcmp(arg, "--seed") == 0) {
+            options.seed = std::strtoull(value, nullptr, 10);
+        } else if (std::strcmp(arg, "--threads") == 0) {
+            options.threads = std::atoi(value);
+        } else if (std::strcmp(arg, "--budget") == 0) {
+            options.guessBudgetMs = std::atof(value);
+        } else if (std::strcmp(arg, "--archive") == 0) {
+            archivePath = value;
+        } else if (std::strcmp(arg, "--write-archive") == 0) {
+            writePath = value;
+        } else if (std::strcmp(arg, "--replay") == 0) {
+            return replayGame(value);
+        } else if (std::strcmp(arg, "--analyze") == 0) {
+            return analyzeGame(value, options.threads);
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+        ++i;  // Skip the consumed value
+    }
+    if (options.rows <= 0 || options.columns <= 0 || options.mines < 0) {
+        std::fprintf(stderr, "Board dimensions must be positive\n");
+        return 1;
+    }
+
+
+    if (writePath) {
+        if (!Simulator::writeArchive(options, writePath)) {
+            std::fprintf(stderr, "Could not write %s\n", writePath);
+            return 1;
+        }
+        std::printf("wrote %u boards to %s\n", options.games, writePath);
+        return 0;
+    }
+
+    // Boards come from the archive, which also decides their size
+    PuzzleArchive archive;
+    if (archivePath) {
+        if (!archive.open(archivePath)) {
+            std::fprintf(stderr, "Could not open puzzle archive %s\n", archivePath);
+            return 1;
+        }
+        options.archive = &archive;
+        options.rows = archive.rows();
+        options.columns = archive.columns();
+        options.mines = archive.mines();
+        options.games = static_cast<uint32_t>(std::min<uint64_t>(options.games, archive.count()));
+    }
+
+    Simulator::Stats stats = Simulator::run(options);
+    double games = static_cast<double>(stats.games);
+    std::printf("games:         %llu\n", static_cast<unsigned long long>(stats.games));
+    std::printf("win rate:      %.2f%%\n", games > 0 ? 100.0 * stats.wins / games : 0.0);
+    std::printf("average moves: %.2f\n", games > 0 ? stats.moves / games : 0.0);
+    std::printf("guesses/game:  %.2f\n", games > 0 ? stats.guesses / games : 0.0);
+    if (stats.skipped > 0) {
+        std::printf("skipped:       %llu malformed archive records\n", static_cast<unsigned long long>(stats.skipped));
+    }
+    std::printf("elapsed:       %.3f s\n", stats.seconds);
+    std::printf("games/second:  %.0f\n", stats.seconds > 0 ? games / stats.seconds : 0.0);
+    return 0;
+}
@@ -0,0 +1,35 @@
+TEMPLATE = app
+TARGET = minesweeper-sim
+
+CONFIG += console c++11 thread
+CONFIG -= app_bundle qt
+
+INCLUDEPATH += ..
+
+HEADERS += \
+    ../analysis.h \
+    ../bitgrid.h \
+    ../bitset.h \
+    ../board.h \
+    ../fileformat.h \
+    ../gamefile.h \
+    ../generator.h \
+    ../movelog.h \
+    ../perf.h \
+    ../probability.h \
+    ../rng.h \
+    ../solver.h \
+    ../workerpool.h \
+    simulator.h
+
+SOURCES += \
+    ../analysis.cpp \
+    ../bitgrid.cpp \
+    ../board.cpp \
+    ../gamefile.cpp \
+    ../generator.cpp \
+    ../movelog.cpp \
+    ../probability.cpp \
+    ../solver.cpp \
+    main.cpp \
+    simulator.cpp
@@ -0,0 +1,221 @@
+#include "simulator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <vector>
+#include "board.h"
+#include "gamefile.h"
+#include "generator.h"
+#include "probability.h"
+#include "rng.h"
+#include "solver.h"
+#include "workerpool.h"
+
+namespace {
+
+// Half-open range of game indices packed into one word, so owner and thieves can update it with a single CAS
+struct WorkRange {
+    std::atomic<uint64_t> bounds;  // Begin in the high half, end in the low half
+    char padding[64 - sizeof(std::atomic<uint64_t>)];  // Keeps each range on its own cache line
+};
+
+uint64_t pack(uint32_t begin, uint32_t end) { return (static_cast<uint64_t>(begin) << 32) | end; }
+uint32_t beginOf(uint64_t bounds) { return static_cast<uint32_t>(bounds >> 32); }
+uint32_t endOf(uint64_t bounds) { return static_cast<uint32_t>(bounds); }
+
+// Per-thread engine instances and statistics
+struct Worker {
+    Board board;
+    Solver solver;
+    ProbabilitySolver probabilities;
+    NoGuessGenerator generator;
+    Simulator::Stats stats;
+};
+
+const uint32_t chunkSize = 64;  // Games taken from the own range at a time
+const double noGuessBudgetMs = 50.0;  // Same generation budget as the GUI
+
+// Takes up to chunkSize games from the front of a range
+bool takeChunk(WorkRange &range, uint32_t &begin, uint32_t &end) {
+    uint64_t bounds = range.bounds.load(std::memory_order_relaxed);
+    while (beginOf(bounds) < endOf(bounds)) {
+        begin = beginOf(bounds);
+        end = std::min(endOf(bounds), begin + chunkSize);
+        if (range.bounds.compare_exchange_weak(bounds, pack(end, endOf(bounds)))) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Moves the back half of the fullest other range into the thief's own, empty range
+bool steal(std::vector<WorkRange> &ranges, size_t thief) {
+    while (true) {
+        size_t victim = ranges.size();
+        uint32_t largest = 0;
+        for (size_t i = 0; i < ranges.size(); ++i) {
+            uint64_t bounds = ranges[i].bounds.load(std::memory_order_relaxed);
+            uint32_t size = endOf(bounds) - beginOf(bounds);
+            if (i != thief && beginOf(bounds) < endOf(bounds) && size > largest) {
+                largest = size;
+                victim = i;
+            }
+        }
+        if (victim == ranges.size()) {
+            return false;  // Nothing left anywhere
+        }
+
+        uint64_t bounds = ranges[victim].bounds.load(std::memory_order_relaxed);
+        uint32_t begin = beginOf(bounds), end = endOf(bounds);
+        if (begin >= end) {
+            continue;
+        }
+        uint32_t middle = begin + (end - begin) / 2;
+        if (ranges[victim].bounds.compare_exchange_strong(bounds, pack(begin, middle))) {
+            ranges[thief].bounds.store(pack(middle, end));
+            return true;
+        }
+    }
+}
+
+// Sets up the board of one game and returns its first click: a board read from the archive, a no-guess layout,
+// or a plain seeded board whose mines are placed by the first click; -1 for a malformed archive record
+int setupBoard(Worker &worker, const Simulator::Options &options, uint32_t game) {
+    Board &board = worker.board;
+    if (options.archive) {
+        return options.archive->load(board, game) ? options.archive->puzzle(game).firstCell : -1;
+    }
+
+    board.setupGame(options.rows, options.columns, options.mines, Simulator::gameSeed(options.seed, game));
+    int row = options.rows / 2, col = options.columns / 2;
+    if (options.noGuess) {
+        NoGuessGenerator::Result layout = worker.generator.generate(board.rows(), board.columns(), board.mineCount(),
+                                                                    board.seed(), row, col, noGuessBudgetMs, 1);
+        board.setupGame(options.rows, options.columns, options.mines, layout.seed);  // Archive records keep this seed
+        board.setMines(layout.mines);
+    }
+    return board.index(row, col);
+}
+
+
+// Reveals cells until the game ends: provably safe cells first, otherwise the least likely mine
+void playGame(Worker &worker, const Simulator::Options &options, uint32_t game) {
+    Board &board = worker.board;
+    int cell = setupBoard(worker, options, game);  // The first click is always safe
+    if (cell < 0) {
+        worker.stats.skipped++;
+        return;
+    }
+    worker.solver.reset(board);
+    worker.probabilities.reset();
+
+    while (true) {
+        const std::vector<int> &revealed = board.revealCell(board.rowOf(cell), board.columnOf(cell));
+        worker.stats.moves++;
+        if (board.state() != Board::Playing) {
+            break;
+        }
+        worker.solver.update(board, revealed);
+
+        cell = worker.solver.findSafeCell(board);
+        if (cell < 0) {
+            cell = worker.probabilities.solve(board, worker.solver, options.guessBudgetMs).bestCell;
+            worker.stats.guesses++;
+        }
+    }
+
+    worker.stats.games++;
+    if (board.state() == Board::Won) {
+        worker.stats.wins++;
+    }
+}
+
+
+// Hands out the game indices to the threads, each thread calling task(worker, game) with its own worker
+template <typename Task>
+void forEachGame(uint32_t games, WorkerPool<Worker> &workers, Task task) {
+    size_t threads = workers.size();
+    std::vector<WorkRange> ranges(threads);
+
+    // Start with an even split, stealing only corrects the imbalance from games of different length
+    for (size_t t = 0; t < threads; ++t) {
+        uint32_t begin = static_cast<uint32_t>(static_cast<uint64_t>(games) * t / threads);
+        uint32_t end = static_cast<uint32_t>(static_cast<uint64_t>(games) * (t + 1) / threads);
+        ranges[t].bounds.store(pack(begin, end));
+    }
+
+    workers.run(threads, [&](size_t t) {
+        uint32_t begin, end;
+        while (true) {
+            if (!takeChunk(ranges[t], begin, end)) {
+                if (!steal(ranges, t)) {
+                    break;  // Every range is empty
+                }
+                continue;
+            }
+            for (uint32_t game = begin; game < end; ++game) {
+                task(workers[t], game);
+            }
+        }
+    });
+}
+
+
+
+}
+
+
+uint64_t Simulator::gameSeed(uint64_t seed, uint64_t game) {
+    return mixSeed(seed + (game + 1) * 0x9E3779B97F4A7C15ULL);
+}
+
+
+Simulator::Stats Simulator::run(const Options &options) {
+    WorkerPool<Worker> workers(WorkerPool<Worker>::threadCount(options.threads));
+    for (size_t t = 0; t < workers.size(); ++t) {
+        workers[t].stats = Stats();
+    }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    forEachGame(options.games, workers, [&options](Worker &worker, uint32_t game) { playGame(worker, options, game); });
+
+    Stats total = Stats();
+    for (size_t t = 0; t < workers.size(); ++t) {
+        const Worker &worker = workers[t];
+        total.games += worker.stats.games;
+        total.wins += worker.stats.wins;
+        total.moves += worker.stats.moves;
+        total.guesses += worker.stats.guesses;
+        total.skipped += worker.stats.skipped;
+    }
+    total.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return total;
+}
+
+
+// Every thread packs its boards straight into their slots of one buffer, which is written out in a single pass
+bool Simulator::writeArchive(const Options &options, const std::string &path) {
+    WorkerPool<Worker> workers(WorkerPool<Worker>::threadCount(options.threads));
+    size_t stride = PuzzleArchive::recordWords(options.rows, options.columns);
+    std::vector<uint64_t> records(stride * options.games);
+    std::atomic<bool> malformed(false);  // Set when a source archive record could not be read
+    Board &sized = workers[0].board;  // Reset by its first game anyway
+    sized.setupGame(options.rows, options.columns, options.mines, 0);
+    int mines = sized.mineCount();  // Clamped like every board in the archive, so the header matches the records
+
+    forEachGame(options.games, workers, [&](Worker &worker, uint32_t game) {
+        Board &board = worker.board;
+        int cell = setupBoard(worker, options, game);
+        if (cell < 0) {
+            malformed.store(true);
+            return;
+        }
+        if (!board.minesPlaced()) {
+            board.placeMines(board.rowOf(cell), board.columnOf(cell));
+        }
+        PuzzleArchive::packRecord(board, cell, options.noGuess, &records[stride * game]);
+    });
+    return !malformed.load() &&
+           PuzzleArchive::write(path, options.rows, options.columns, mines, records.data(), options.games);
+}
@@ -0,0 +1,40 @@
+#ifndef SIMULATOR_H
+#define SIMULATOR_H
+
+#include <cstdint>
+#include <string>
+
+class PuzzleArchive;
+
+// Plays many seeded games headlessly with the hint solver as the policy
+// Game indices are split into per-thread ranges; an idle thread steals half of the largest remaining range,
+// and every thread owns its engine instances, so workers never share mutable game state
+class Simulator {
+public:
+    struct Options {
+        int rows;  // Board height
+        int columns;  // Board width
+        int mines;  // Mines per board
+        uint64_t seed;  // Base seed, game i uses a seed derived from it and i
+        uint32_t games;  // Number of games to play
+        int threads;  // Worker threads, 0 picks one per core
+        double guessBudgetMs;  // Time budget of the probability solver per guess
+        bool noGuess;  // Generate boards that need no guess instead of plain seeded boards
+        const PuzzleArchive *archive;  // Boards to play instead of generating them, nullptr for none
+    };
+
+    struct Stats {
+        uint64_t games;  // Games played
+        uint64_t wins;  // Games won
+        uint64_t moves;  // Reveals made over all games
+        uint64_t guesses;  // Reveals that were not provably safe
+        uint64_t skipped;  // Malformed archive records, not played
+        double seconds;  // Wall-clock time of the run
+    };
+
+    static Stats run(const Options &options);  // Plays every game and returns the combined statistics
+    static bool writeArchive(const Options &options, const std::string &path);  // Generates the boards of run() into a puzzle archive
+    static uint64_t gameSeed(uint64_t seed, uint64_t game);  // Seed of one game, so any game can be replayed alone
+};
+
+#endif // SIMULATOR_H
@@ -0,0 +1,235 @@
+#include "solver.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include "perf.h"
+
+// Forgets every deduction and sizes the bitsets for the board
+void Solver::reset(const Board &board) {
+    knownMines.resize(board.cellCount());
+    knownSafe.resize(board.cellCount());
+    queued.resize(board.cellCount());
+    inFrontier.resize(board.cellCount());
+    workQueue.clear();
+    frontierCells.clear();
+    safeCells.clear();
+}
+
+
+// The work queue and the frontier are part of the deductions, they say what is left to examine
+void Solver::snapshot(const Solver &source) {
+    knownMines = source.knownMines;
+    knownSafe = source.knownSafe;
+    queued = source.queued;
+    inFrontier = source.inFrontier;
+    workQueue = source.workQueue;
+    frontierCells = source.frontierCells;
+    safeCells = source.safeCells;
+}
+
+
+// Starts over from the revealed cells currently on the board
+// Bitboard kernels apply the first rule 64 cells at a time: a revealed number with as many hidden neighbours as
+// adjacent mines has only mines around it. Only the numbers still next to an unknown cell are queued afterwards,
+// so on a large board the per-cell rules see the unresolved edge of the frontier instead of all of it
+void Solver::rebuild(const Board &board) {
+    PERF_SCOPE("solver rebuild");
+    reset(board);
+    const BitGrid &revealed = board.revealedBits();
+    revealed.complement(hidden);
+    hidden.dilate(nearHidden);
+    nearHidden.intersect(revealed);  // Revealed cells with a hidden neighbour
+
+    board.mineBits().neighbourCounts(numbers);  // Only read at revealed cells, where they are the numbers shown
+    hidden.neighbourCounts(hiddenCounts);
+    saturated.equalCounts(numbers, hiddenCounts);
+    saturated.intersect(nearHidden);
+    saturated.dilate(mineGrid);
+    mineGrid.intersect(hidden);
+    mineGrid.forEach([this, &board](int row, int col) { knownMines.set(board.index(row, col)); });
+
+    hidden.subtract(mineGrid);  // Hidden cells still unknown
+    hidden.dilate(nearHidden);
+    nearHidden.intersect(revealed);
+    nearHidden.forEach([this, &board](int row, int col) { queueCell(board, board.index(row, col)); });
+}
+
+
+// Every newly revealed number is a new constraint, and every revealed number around a newly revealed cell lost a hidden neighbour
+// Unlike rebuild() this stays per cell: a batch touches a few cells around each reveal, where a bitboard pass
+// would cost the whole board every time
+void Solver::update(const Board &board, const std::vector<int> &revealed) {
+    PERF_SCOPE("solver update");
+    for (int cell : revealed) {
+        queueCell(board, cell);
+        queueNeighbours(board, cell);
+    }
+}
+
+
+int Solver::findSafeCell(const Board &board) {
+    propagate(board);
+    while (!safeCells.empty() && board.isRevealed(safeCells.back())) {
+        safeCells.pop_back();  // Drop safe cells the player has revealed since
+    }
+    return safeCells.empty() ? -1 : safeCells.back();
+}
+
+
+void Solver::queueCell(const Board &board, int cell) {
+    if (board.isRevealed(cell) && board.adjacentMines(cell) > 0 && !queued.test(cell)) {
+        queued.set(cell);
+        workQueue.push_back(cell);
+    }
+}
+
+
+void Solver::queueNeighbours(const Board &board, int cell) {
+    int neighbours[8];
+    int count = board.neighbours(cell, neighbours);
+    for (int i = 0; i < count; ++i) {
+        queueCell(board, neighbours[i]);
+    }
+}
+
+
+Solver::Constraint Solver::constraintOf(const Board &board, int cell) const {
+    Constraint constraint;
+    constraint.size = 0;
+    constraint.mines = board.adjacentMines(cell);
+
+    int neighbours[8];
+    int count = board.neighbours(cell, neighbours);
+    for (int i = 0; i < count; ++i) {
+        int neighbour = neighbours[i];
+        if (board.isRevealed(neighbour) || knownSafe.test(neighbour)) {
+            continue;
+        }
+        if (knownMines.test(neighbour)) {
+            constraint.mines--;
+        } else {
+            constraint.unknown[constraint.size++] = neighbour;
+        }
+    }
+    return constraint;
+}
+
+
+void Solver::markMine(const Board &board, int cell) {
+    if (!knownMines.test(cell)) {
+        knownMines.set(cell);
+        queueNeighbours(board, cell);  // Every number around the mine has one unknown less
+    }
+}
+
+
+void Solver::markSafe(const Board &board, int cell) {
+    if (!knownSafe.test(cell)) {
+        knownSafe.set(cell);
+        safeCells.push_back(cell);
+        queueNeighbours(board, cell);
+    }
+}
+
+
+// Splits two constraints into the cells only the first sees (A), only the second sees (B) and the shared ones
+// Since mines(B) - mines(A) equals the difference of the two counts, B is all mines and A is all safe when that
+// difference equals |B|, and the other way round when it equals -|A|; this covers the subset and 1-2-1 patterns
+bool Solver::applyPairRule(const Board &board, const Constraint &first, const Constraint &second) {
+    int onlyFirst[8], onlySecond[8];
+    int firstCount = 0, secondCount = 0;
+    for (int i = 0; i < first.size; ++i) {
+        if (std::find(second.unknown, second.unknown + second.size, first.unknown[i]) == second.unknown + second.size) {
+            onlyFirst[firstCount++] = first.unknown[i];
+        }
+    }
+    for (int i = 0; i < second.size; ++i) {
+        if (std::find(first.unknown, first.unknown + first.size, second.unknown[i]) == first.unknown + first.size) {
+            onlySecond[secondCount++] = second.unknown[i];
+        }
+    }
+    if (firstCount == first.size) {
+        return false;  // No shared cells, nothing to learn
+    }
+
+    int difference = second.mines - first.mines;
+    if (difference == secondCount && firstCount + secondCount > 0) {
+        for (int i = 0; i < secondCount; ++i) {
+            markMine(board, onlySecond[i]);
+        }
+        for (int i = 0; i < firstCount; ++i) {
+            markSafe(board, onlyFirst[i]);
+        }
+        return true;
+    }
+    if (-difference == firstCount && firstCount + secondCount > 0) {
+        for (int i = 0; i < firstCount; ++i) {
+            markMine(board, onlyFirst[i]);
+        }
+        for (int i = 0; i < secondCount; ++i) {
+            markSafe(board, onlySecond[i]);
+        }
+        return true;
+    }
+    return false;
+}
+
+
+// Examines queued numbers until no rule applies anymore
+// A deduction re-queues the numbers around the deduced cell, so only the affected part of the frontier is revisited
+void Solver::propagate(const Board &board) {
+    int64_t iterations = 0;
+    while (!workQueue.empty()) {
+        iterations++;
+        int cell = workQueue.back();
+        workQueue.pop_back();
+        queued.reset(cell);
+
+        Constraint constraint = constraintOf(board, cell);
+        if (constraint.size == 0) {
+            inFrontier.reset(cell);  // Fully resolved, leaves the frontier
+            continue;
+        }
+        if (!inFrontier.test(cell)) {
+            inFrontier.set(cell);
+            frontierCells.push_back(cell);
+        }
+
+        // Single-cell rules: no mines left means the rest is safe, as many mines as unknowns means they are all mines
+        if (constraint.mines == 0) {
+            for (int i = 0; i < constraint.size; ++i) {
+                markSafe(board, constraint.unknown[i]);
+            }
+            continue;
+        }
+        if (constraint.mines == constraint.size) {
+            for (int i = 0; i < constraint.size; ++i) {
+                markMine(board, constraint.unknown[i]);
+            }
+            continue;
+        }
+
+        // Pair rule against every revealed number close enough to share an unknown cell
+        int row = board.rowOf(cell);
+        int col = board.columnOf(cell);
+        bool changed = false;
+        for (int r = std::max(0, row - 2); r <= std::min(board.rows() - 1, row + 2) && !changed; ++r) {
+            for (int c = std::max(0, col - 2); c <= std::min(board.columns() - 1, col + 2) && !changed; ++c) {
+                int other = board.index(r, c);
+                if (other == cell || !board.isRevealed(other) || board.adjacentMines(other) == 0) {
+                    continue;
+                }
+                Constraint otherConstraint = constraintOf(board, other);
+                if (otherConstraint.size > 0) {
+                    changed = applyPairRule(board, constraint, otherConstraint);  // The cell is re-queued by any deduction
+                }
+            }
+        }
+    }
+    PERF_COUNT("solver iterations", iterations);
+
+    // Drop resolved numbers from the frontier list
+    frontierCells.erase(std::remove_if(frontierCells.begin(), frontierCells.end(),
+                                       [this](int cell) { return !inFrontier.test(cell); }),
+                        frontierCells.end());
+}
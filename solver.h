@@ -0,0 +1,54 @@
+#ifndef SOLVER_H
+#define SOLVER_H
+
+#include <vector>
+#include "bitgrid.h"
+#include "bitset.h"
+#include "board.h"
+
+// Deduces safe cells and mines from the revealed numbers only, never from the hidden layout or the player's flags
+// Only the frontier (revealed numbers next to unresolved hidden cells) is examined, and only the parts of it
+// touched by a reveal or a deduction since the last call, so each hint costs time proportional to what changed
+class Solver {
+public:
+    struct Constraint {
+        int unknown[8];  // Hidden neighbours that are neither known mines nor known safe
+        int size;  // Number of entries in unknown
+        int mines;  // Mines among the unknown neighbours
+    };
+
+    void reset(const Board &board);  // Starts tracking a new game
+    void rebuild(const Board &board);  // Rescans a board whose revealed cells changed outside of update()
+    void update(const Board &board, const std::vector<int> &revealed);  // Accounts for a batch of newly revealed cells
+    int findSafeCell(const Board &board);  // Returns a hidden cell that is provably safe, or -1 if none is known
+    void snapshot(const Solver &source);  // Copies the deductions of source without its scratch bitboards
+
+    bool isKnownMine(int cell) const { return knownMines.test(cell); }
+    bool isKnownSafe(int cell) const { return knownSafe.test(cell); }
+    const std::vector<int> &frontier() const { return frontierCells; }  // Revealed numbers that may still constrain hidden cells
+    Constraint constraintOf(const Board &board, int cell) const;  // Collects what is still unknown around a revealed number
+
+private:
+    void propagate(const Board &board);  // Applies the rules to every queued cell until nothing changes
+    void queueCell(const Board &board, int cell);  // Schedules a revealed number for re-examination
+    void queueNeighbours(const Board &board, int cell);  // Schedules the revealed numbers around a cell
+    bool applyPairRule(const Board &board, const Constraint &first, const Constraint &second);  // Compares two overlapping numbers
+    void markMine(const Board &board, int cell);
+    void markSafe(const Board &board, int cell);
+
+    Bitset knownMines;  // Hidden cells proved to be mines
+    Bitset knownSafe;  // Hidden cells proved to be safe
+    Bitset queued;  // Cells currently in the work queue
+    Bitset inFrontier;  // Cells currently in frontierCells
+    BitGrid hidden;  // Scratch bitboard of the hidden cells, used by rebuild()
+    BitGrid nearHidden;  // Scratch bitboard of the cells next to a hidden cell
+    BitGrid numbers[4];  // Scratch count planes of the adjacent mines, only read at revealed cells
+    BitGrid hiddenCounts[4];  // Scratch count planes of the hidden neighbours
+    BitGrid saturated;  // Scratch bitboard of the numbers whose hidden neighbours are all mines
+    BitGrid mineGrid;  // Scratch bitboard of the mines found by rebuild()
+    std::vector<int> workQueue;  // Revealed numbers waiting to be examined
+    std::vector<int> frontierCells;  // Revealed numbers with unresolved hidden neighbours, pruned lazily
+    std::vector<int> safeCells;  // Known safe cells, the hidden ones are hint candidates
+};
+
+#endif // SOLVER_H
@@ -0,0 +1,49 @@
+#ifndef WORKERPOOL_H
+#define WORKERPOOL_H
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+// Per-thread scratch state and the threads that use it, for work split over every core
+// Each worker is padded onto its own cache lines, so neighbouring threads never share one, and is kept between
+// runs, so buffers grown by one batch are reused by the next
+template <typename Worker>
+class WorkerPool {
+public:
+    explicit WorkerPool(size_t count = 0) : slots(count) {}
+
+    static size_t threadCount(int requested) {  // The requested number of threads, 0 for one per core
+        return requested > 0 ? static_cast<size_t>(requested) : std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    void resize(size_t count) { slots.resize(count); }  // Existing workers keep their state, new ones are value-initialised
+    size_t size() const { return slots.size(); }
+    Worker &operator[](size_t thread) { return slots[thread].worker; }
+    const Worker &operator[](size_t thread) const { return slots[thread].worker; }
+
+    // Calls task(t) for t from 0 to count - 1 on threads of its own and returns once every call finished
+    // The calling thread runs task(0) itself, so a single thread needs no extra thread at all
+    template <typename Task>
+    void run(size_t count, Task task) {
+        std::vector<std::thread> threads;
+        for (size_t t = 1; t < count; ++t) {
+            threads.push_back(std::thread([&task, t]() { task(t); }));
+        }
+        task(0);
+        for (std::thread &thread : threads) {
+            thread.join();
+        }
+    }
+
+private:
+    struct Slot {
+        Worker worker;
+        char padding[64];
+    };
+
+    std::vector<Slot> slots;  // One per thread
+};
+
+#endif // WORKERPOOL_H